@@ -0,0 +1,13 @@
+/* 13 tap horizontal gaussian blur of iChannel0 */
+
+void mainImage(out vec4 fragColor, in vec2 fragCoord)
+{
+    const float w[7] = float[7](0.1964, 0.1748, 0.1232, 0.0688, 0.0304, 0.0107, 0.0030);
+    vec2 px = vec2(1.0 / iResolution.x, 0.0), uv = fragCoord / iResolution.xy;
+    vec3 col = texture(iChannel0, uv).rgb * w[0];
+    for (int i = 1; i < 7; ++i) {
+        col += texture(iChannel0, uv + px * float(i)).rgb * w[i];
+        col += texture(iChannel0, uv - px * float(i)).rgb * w[i];
+    }
+    fragColor = vec4(col, 1.0);
+}
@@ -0,0 +1,27 @@
+/* gray-scott reaction diffusion, run as 'feedback.frag:0' so it reads itself */
+
+void mainImage(out vec4 fragColor, in vec2 fragCoord)
+{
+    vec2 px = 1.0 / iResolution.xy, uv = fragCoord * px;
+    vec2 c = texture(iChannel0, uv).xy;
+    if (iFrame < 2) {
+        float seed = step(length(fragCoord - 0.5 * iResolution.xy), 24.0);
+        fragColor = vec4(1.0, seed, 0.0, 1.0);
+        return;
+    }
+
+    vec2 lap = -c;
+    lap += 0.2 * texture(iChannel0, uv + vec2(px.x, 0.0)).xy;
+    lap += 0.2 * texture(iChannel0, uv - vec2(px.x, 0.0)).xy;
+    lap += 0.2 * texture(iChannel0, uv + vec2(0.0, px.y)).xy;
+    lap += 0.2 * texture(iChannel0, uv - vec2(0.0, px.y)).xy;
+    lap += 0.05 * texture(iChannel0, uv + px).xy;
+    lap += 0.05 * texture(iChannel0, uv - px).xy;
+    lap += 0.05 * texture(iChannel0, uv + vec2(px.x, -px.y)).xy;
+    lap += 0.05 * texture(iChannel0, uv - vec2(px.x, -px.y)).xy;
+
+    float reaction = c.x * c.y * c.y;
+    vec2 d = vec2(lap.x - reaction + 0.0545 * (1.0 - c.x),
+                  0.5 * lap.y + reaction - (0.062 + 0.0545) * c.y);
+    fragColor = vec4(clamp(c + d, 0.0, 1.0), 0.0, 1.0);
+}
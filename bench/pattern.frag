@@ -0,0 +1,9 @@
+/* high frequency source image for the blur chain */
+
+void mainImage(out vec4 fragColor, in vec2 fragCoord)
+{
+    vec2 uv = fragCoord / iResolution.y;
+    vec2 g = step(0.5, fract(uv * 16.0 + 0.1 * iTime));
+    float c = abs(g.x - g.y);
+    fragColor = vec4(c * (0.5 + 0.5 * cos(iTime + uv.xyx * 6.0 + vec3(0.0, 2.0, 4.0))), 1.0);
+}
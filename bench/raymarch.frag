@@ -0,0 +1,77 @@
+/* raymarched signed distance scene with soft shadows and ambient occlusion */
+
+float sdBox(vec3 p, vec3 b)
+{
+    vec3 q = abs(p) - b;
+    return length(max(q, 0.0)) + min(max(q.x, max(q.y, q.z)), 0.0);
+}
+
+float map(vec3 p)
+{
+    vec3 q = p;
+    q.xz = mod(q.xz + 2.0, 4.0) - 2.0;
+    float d = length(q - vec3(0.0, 0.6 + 0.3 * sin(iTime + p.x), 0.0)) - 0.6;
+    d = min(d, sdBox(q - vec3(0.0, 0.2, 0.0), vec3(1.2, 0.2, 1.2)) - 0.05);
+    return min(d, p.y + 0.1 * sin(p.x * 2.0) * sin(p.z * 2.0));
+}
+
+vec3 normal(vec3 p)
+{
+    const vec2 e = vec2(0.001, 0.0);
+    return normalize(vec3(
+        map(p + e.xyy) - map(p - e.xyy),
+        map(p + e.yxy) - map(p - e.yxy),
+        map(p + e.yyx) - map(p - e.yyx)
+    ));
+}
+
+float shadow(vec3 ro, vec3 rd)
+{
+    float res = 1.0, t = 0.02;
+    for (int i = 0; i < 48; ++i) {
+        float h = map(ro + rd * t);
+        res = min(res, 8.0 * h / t);
+        t += clamp(h, 0.02, 0.5);
+        if (res < 0.001 || t > 20.0) break;
+    }
+    return clamp(res, 0.0, 1.0);
+}
+
+float occlusion(vec3 p, vec3 n)
+{
+    float occ = 0.0, s = 1.0;
+    for (int i = 1; i <= 5; ++i) {
+        float h = 0.03 * float(i);
+        occ += (h - map(p + n * h)) * s;
+        s *= 0.9;
+    }
+    return clamp(1.0 - 3.0 * occ, 0.0, 1.0);
+}
+
+void mainImage(out vec4 fragColor, in vec2 fragCoord)
+{
+    vec2 uv = (2.0 * fragCoord - iResolution.xy) / iResolution.y;
+    vec3 ro = vec3(4.0 * cos(0.2 * iTime), 2.0, 4.0 * sin(0.2 * iTime));
+    vec3 ww = normalize(-ro + vec3(0.0, 0.5, 0.0));
+    vec3 uu = normalize(cross(ww, vec3(0.0, 1.0, 0.0)));
+    vec3 vv = cross(uu, ww);
+    vec3 rd = normalize(uv.x * uu + uv.y * vv + 1.8 * ww);
+
+    float t = 0.0;
+    for (int i = 0; i < 128; ++i) {
+        float h = map(ro + rd * t);
+        if (h < 0.0005 * t || t > 40.0) break;
+        t += h;
+    }
+
+    vec3 col = vec3(0.6, 0.7, 0.9) - 0.5 * rd.y;
+    if (t < 40.0) {
+        vec3 p = ro + rd * t, n = normal(p);
+        vec3 l = normalize(vec3(0.6, 0.8, -0.4));
+        float dif = clamp(dot(n, l), 0.0, 1.0) * shadow(p, l);
+        col = vec3(0.9, 0.8, 0.6) * dif + vec3(0.15, 0.2, 0.3) * occlusion(p, n);
+        col = mix(col, vec3(0.6, 0.7, 0.9), 1.0 - exp(-0.002 * t * t));
+    }
+
+    fragColor = vec4(pow(col, vec3(0.4545)), 1.0);
+}
@@ -15,6 +15,10 @@ wflags=(
 
 libs=(
     -lglfw
+    -lz
+    -ljpeg
+    -lpthread
+    -lm
 )
 
 mac=(
@@ -24,10 +28,11 @@ mac=(
 linux=(
     -lGL
     -lGLEW
+    -lEGL
 )
 
 if echo "$OSTYPE" | grep -q "linux"; then
-    libs+=(-lGL -lGLEW)
+    libs+=(-lGL -lGLEW -lEGL)
 elif echo "$OSTYPE" | grep -q "darwin"; then 
     libs+=(-framework OpenGL)
 fi
@@ -24,21 +24,58 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 *********************  glook.c  *************************/
 
+#ifndef __APPLE__
+    #define _POSIX_C_SOURCE 200809L
+#endif
+
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <signal.h>
+#include <pthread.h>
+#include <zlib.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
 #include <ctype.h>
+#include <errno.h>
 #include <time.h>
+#include <math.h>
+#include <setjmp.h>
+#include <jpeglib.h>
+
+#ifdef __linux__
+    #include <sys/inotify.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+    #define GLOOK_SIMD_X86
+    #include <immintrin.h>
+#endif
+
+#ifdef __GNUC__
+    #define GLOOK_ATOMIC_LOAD(p) __atomic_load_n(p, __ATOMIC_ACQUIRE)
+    #define GLOOK_ATOMIC_STORE(p, v) __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#else
+    #define GLOOK_ATOMIC_LOAD(p) (*(volatile int*)(p))
+    #define GLOOK_ATOMIC_STORE(p, v) (*(volatile int*)(p) = (v))
+#endif
 
 #ifndef __APPLE__
     #define GLOOK_SCALE 1
     #define GLOOK_GLSL_VERSION "#version 300 es\n\nprecision mediump float;\n\n"
+    #define GLOOK_GLSL_LINE_COUNT 4
     #include <GL/glew.h>
+    #include <EGL/egl.h>
+    #include <EGL/eglext.h>
 #else
     #define GLOOK_SCALE 2
     #define GLOOK_GLSL_VERSION "#version 330 core\n\n"
+    #define GLOOK_GLSL_LINE_COUNT 2
     #define GL_SILENCE_DEPRECATION
     #define GLFW_INCLUDE_GLCOREARB
 #endif
@@ -51,8 +88,66 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define GLOOK_SHADER_COUNT 8
 #define GLOOK_INPUT_COUNT 4
 #define GLOOK_KEYBOARD_COUNT 1024
-#define GLOOK_COMMON_LINE_COUNT 24
-#define GLOOK_AUTORELOAD_COUNT 32
+#define GLOOK_COMMON_LINE_COUNT (GLOOK_GLSL_LINE_COUNT + 31)
+#define GLOOK_UBO_FRAME 0
+#define GLOOK_UBO_PASS 1
+#define GLOOK_WATCH_COUNT (GLOOK_SHADER_COUNT + 1)
+#define GLOOK_WATCH_DELAY 0.05
+#define GLOOK_WATCH_POLL 0.25
+#define GLOOK_STATS_COUNT 64
+#define GLOOK_POOL_COUNT 16
+#define GLOOK_DYNRES_STEPS 8
+#define GLOOK_DYNRES_MIN 2
+#define GLOOK_DYNRES_FRAMES 32
+#define GLOOK_RESIZE_DELAY 0.1
+#define GLOOK_BENCH_WARMUP 32
+#define GLOOK_BENCH_BLOCK 16
+#define GLOOK_CACHE_MAGIC 0x424B4C47
+#define GLOOK_CACHE_MAX (64 << 20)
+#define GLOOK_IMAGE_MAGIC 0x584B4C47
+#define GLOOK_IMAGE_HEADER 16
+#define GLOOK_IMAGE_MAX (1 << 15)
+#define GLOOK_IMAGE_COUNT (GLOOK_SHADER_COUNT * GLOOK_INPUT_COUNT)
+#define GLOOK_STREAM_COUNT GLOOK_SHADER_COUNT
+#define GLOOK_STREAM_RING 4
+#define GLOOK_STREAM_PBOS 2
+#define GLOOK_AUDIO_COUNT GLOOK_INPUT_COUNT
+#define GLOOK_AUDIO_FFT 2048
+#define GLOOK_AUDIO_WIDTH 512
+
+#define GLOOK_TRACE_CPU 1
+#define GLOOK_TRACE_GPU 2
+#define GLOOK_HEADLESS_FPS 60
+#define GLOOK_READBACK_COUNT 4
+#define GLOOK_TILE_IDAT (1 << 16)
+#define GLOOK_R2_X 0.7548776662466927
+#define GLOOK_R2_Y 0.5698402909980532
+
+#define GLOOK_ENCODER_THREADS 8
+#define GLOOK_ENCODER_QUEUE 8
+#define GLOOK_CHECK_WORKERS 16
+
+#define GLOOK_EXPORT_NONE 0x0
+#define GLOOK_EXPORT_RAW 0x1
+#define GLOOK_EXPORT_Y4M 0x2
+#define GLOOK_EXPORT_PNG 0x3
+#define GLOOK_EXPORT_QOI 0x4
+#define GLOOK_EXPORT_GOLDEN 0x5
+
+#define GLOOK_PROGRAM_NONE 0x0
+#define GLOOK_PROGRAM_QUEUED 0x1
+#define GLOOK_PROGRAM_ISSUED 0x2
+
+#define GLOOK_IMAGE_NONE 0x0
+#define GLOOK_IMAGE_QUEUED 0x1
+#define GLOOK_IMAGE_DECODED 0x2
+#define GLOOK_IMAGE_READY 0x3
+#define GLOOK_IMAGE_FAILED 0x4
+
+#define GLOOK_CHECK_NONE 0x0
+#define GLOOK_CHECK_PASSED 0x1
+#define GLOOK_CHECK_FAILED 0x2
+#define GLOOK_CHECK_CRASHED 0x3
 
 #define GLOOK_MODE_BUILD 0x0
 #define GLOOK_MODE_CHAIN 0x1
@@ -64,48 +159,56 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define COLOFF  "\033[m"
 
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
 
 static const char glook_shader_body[] = GLOOK_GLSL_VERSION
 "out vec4 _glookFragColor;\n\n"
 
-"uniform float iTime;\n"
-"uniform float iTimeDelta;\n"
-"uniform int iFrame;\n"
-"uniform float iFrameRate;\n"
-"uniform vec4 iDate;\n"
-"uniform vec3 iResolution;\n"
-"uniform vec4 iMouse;\n"
+"layout (std140) uniform _glookFrame {\n"
+"    highp vec4 iMouse;\n"
+"    highp vec4 iDate;\n"
+"    highp float iTime;\n"
+"    highp float iTimeDelta;\n"
+"    highp float iFrameRate;\n"
+"    highp int iFrame;\n"
+"};\n\n"
+
+"layout (std140) uniform _glookPass {\n"
+"    vec3 iResolution;\n"
+"    vec3 iChannelResolution[4];\n"
+"    highp vec2 _glookOffset;\n"
+"};\n\n"
+
 "uniform sampler2D iChannel0;\n"
 "uniform sampler2D iChannel1;\n"
 "uniform sampler2D iChannel2;\n"
-"uniform sampler2D iChannel3;\n"
-"uniform vec3 iChannelResolution[4];\n\n"
+"uniform sampler2D iChannel3;\n\n"
 
 "void mainImage(out vec4, in vec2);\n\n"
 
 "void main(void)\n"
 "{\n"
 "    vec4 col = vec4(0.0);\n"
-"    mainImage(col, gl_FragCoord.xy);\n"
+"    mainImage(col, gl_FragCoord.xy + _glookOffset);\n"
 "    _glookFragColor = col;\n"
 "}\n\n";
 
-static const char glook_shader_string_quad[] = GLOOK_GLSL_VERSION
-"layout (location = 0) in vec2 vertCoord;\n\n"
-
+static const char glook_shader_string_triangle[] = GLOOK_GLSL_VERSION
 "void main(void)\n"
 "{\n"
-"    gl_Position = vec4(vertCoord.xy, 0.0, 1.0);\n"
+"    vec2 p = vec2(float((gl_VertexID & 1) << 2), float((gl_VertexID & 2) << 1));\n"
+"    gl_Position = vec4(p - 1.0, 0.0, 1.0);\n"
 "}\n";
 
 static const char glook_shader_string_pass[] = GLOOK_GLSL_VERSION 
 "out vec4 _glookFragColor;\n\n"
 
+"uniform vec3 iResolution;\n"
 "uniform sampler2D iChannel0;\n\n"
 
 "void main(void)\n"
 "{\n"
-"    vec3 col = texelFetch(iChannel0, ivec2(gl_FragCoord.xy), 0).rgb;\n"
+"    vec3 col = texture(iChannel0, gl_FragCoord.xy / iResolution.xy).rgb;\n"
 "    _glookFragColor = vec4(clamp(col, 0.0, 1.0), 1.0);\n"
 "}\n";
 
@@ -127,6 +230,7 @@ static const char glook_shader_string_template_pass[] =
 
 struct texture {
     unsigned int id;
+    unsigned int format;
     int width;
     int height;
 };
@@ -136,32 +240,92 @@ struct framebuffer {
     struct texture texture;
 };
 
+struct resolution {
+    int num;
+    int den;
+    int width;
+    int height;
+};
+
 struct input {
-    enum input_type { GLOOK_FRAMEBUFFER, GLOOK_TEXTURE } type;
+    enum input_type { GLOOK_FRAMEBUFFER, GLOOK_TEXTURE, GLOOK_STREAM, GLOOK_AUDIO } type;
     void* data;
 };
 
+struct stats {
+    int head;
+    int count;
+    float samples[GLOOK_STATS_COUNT];
+};
+
+struct timer {
+    int index;
+    int samples;
+    float last;
+    int pending[2];
+    unsigned int queries[2];
+    unsigned int stamps[2];
+    struct stats stats;
+};
+
 struct ulocator {
-    unsigned int iTime;
-    unsigned int iTimeDelta;
-    unsigned int iFrame;
-    unsigned int iFrameRate;
-    unsigned int iDate;
-    unsigned int iMouse;
     unsigned int iResolution;
     unsigned int iChannels[GLOOK_INPUT_COUNT];
-    unsigned int iChannelResolution[GLOOK_INPUT_COUNT];
+};
+
+/* std140 mirrors of the uniform blocks in glook_shader_body */
+
+struct uframe {
+    float iMouse[4];
+    float iDate[4];
+    float iTime;
+    float iTimeDelta;
+    float iFrameRate;
+    int iFrame;
+};
+
+struct upass {
+    float iResolution[4];
+    float iChannelResolution[GLOOK_INPUT_COUNT][4];
+    float offset[4];
+};
+
+struct ubuffer {
+    unsigned int id;
+    int live;
+    time_t epoch;
+    double start;
+};
+
+struct program {
+    unsigned int id;
+    unsigned int fshader;
+    unsigned int format;
+    struct resolution target;
+    int status;
+    double start;
+    char* source;
+    unsigned long hash[2];
+    unsigned long commonhash[2];
 };
 
 struct shader {
     char* fpath;
     unsigned int id;
-    int rendered;
+    unsigned int ubo;
+    unsigned int format;
+    struct resolution resolution;
+    struct resolution target;
     int inputcount;
     struct ulocator locator;
     struct pipeline* pipeline;
     struct input inputs[GLOOK_INPUT_COUNT];
     struct framebuffer framebuffer;
+    struct framebuffer history;
+    struct timer timer;
+    struct program pending;
+    unsigned long hash[2];
+    unsigned long commonhash[2];
 };
 
 struct common {
@@ -169,28 +333,303 @@ struct common {
     char* source;
     size_t length;
     size_t linecount;
+    unsigned long hash[2];
+};
+
+struct command {
+    struct shader* shader;
+    const struct texture* bindings[GLOOK_INPUT_COUNT];
+};
+
+struct graph {
+    struct shader* head;
+    int count;
+    struct command commands[GLOOK_SHADER_COUNT];
 };
 
 struct pipeline {
     int count;
     int capacity;
+    int stale;
     struct common common;
+    struct graph graph;
     struct shader shaders[GLOOK_SHADER_COUNT];
 };
 
+struct state {
+    unsigned int program;
+    unsigned int draw;
+    unsigned int read;
+    unsigned int unit;
+    int viewport[2];
+    unsigned int textures[GLOOK_INPUT_COUNT];
+};
+
+struct pool {
+    int count;
+    struct framebuffer framebuffers[GLOOK_POOL_COUNT];
+};
+
+struct encoder {
+    char* pattern;
+    unsigned int format;
+    int width;
+    int height;
+    int threadcount;
+    int head;
+    int count;
+    int done;
+    int failed;
+    pthread_mutex_t lock;
+    pthread_cond_t notempty;
+    pthread_cond_t notfull;
+    pthread_t threads[GLOOK_ENCODER_THREADS];
+    struct encoder_job {
+        int frame;
+        unsigned char* pixels;
+    } jobs[GLOOK_ENCODER_QUEUE];
+};
+
+struct compiler {
+    GLFWwindow* context;
+    int running;
+    int failed;
+    int done;
+    int head;
+    int count;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    struct program* jobs[GLOOK_SHADER_COUNT];
+};
+
+struct image {
+    char* path;
+    int status;
+    int width;
+    int height;
+    int hdr;
+    void* pixels;
+    void* map;
+    size_t mapsize;
+    struct texture texture;
+};
+
+struct stream {
+    char* path;
+    int sequence;
+    int first;
+    int count;
+    int width;
+    int height;
+    int chroma[2];
+    double fps;
+    long offset;
+    long framesize;
+    FILE* file;
+    unsigned char* planes;
+    unsigned char* slots;
+    int frames[GLOOK_STREAM_RING];
+    int epochs[GLOOK_STREAM_RING];
+    int ready;
+    int done;
+    int head;
+    int tail;
+    int cursor;
+    int epoch;
+    int seek;
+    int ack;
+    int running;
+    int shown;
+    int pbo;
+    pthread_t thread;
+    unsigned int pbos[GLOOK_STREAM_PBOS];
+    struct texture texture;
+};
+
+struct audio {
+    char* path;
+    int channels;
+    int rate;
+    int bits;
+    int isfloat;
+    long frames;
+    const unsigned char* samples;
+    void* map;
+    size_t mapsize;
+    int running;
+    int done;
+    int published;
+    long request;
+    long results[2];
+    long shown;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    float window[GLOOK_AUDIO_FFT];
+    float twr[GLOOK_AUDIO_FFT];
+    float twi[GLOOK_AUDIO_FFT];
+    unsigned char rows[2][GLOOK_AUDIO_WIDTH * 2];
+    struct texture texture;
+};
+
+struct loader {
+    int running;
+    int failed;
+    int done;
+    int head;
+    int count;
+    int pending;
+    int imagecount;
+    int streamcount;
+    int audiocount;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    struct image* jobs[GLOOK_IMAGE_COUNT];
+    struct image images[GLOOK_IMAGE_COUNT];
+    struct stream streams[GLOOK_STREAM_COUNT];
+    struct audio audios[GLOOK_AUDIO_COUNT];
+};
+
+struct watcher {
+    int fd;
+    int count;
+    int dirty;
+    double last;
+    double polled;
+    struct watch {
+        int wd;
+        const char* path;
+        const char* name;
+        time_t mtime;
+    } watches[GLOOK_WATCH_COUNT];
+};
+
+struct dynres {
+    float target;
+    int level;
+    struct stats stats;
+};
+
+struct trace {
+    FILE* file;
+    double start;
+    double gpuclock;
+    GLint64 gpustamp;
+};
+
+struct readback {
+    FILE* file;
+    unsigned int format;
+    int width;
+    int height;
+    int head;
+    int count;
+    int convert;
+    int failed;
+    unsigned char* yuv;
+    unsigned char* grey;
+    struct encoder* encoder;
+    struct framebuffer resolve;
+    int frames[GLOOK_READBACK_COUNT];
+    unsigned int layouts[GLOOK_READBACK_COUNT];
+    unsigned int types[GLOOK_READBACK_COUNT];
+    unsigned int pbos[GLOOK_READBACK_COUNT];
+    GLsync fences[GLOOK_READBACK_COUNT];
+};
+
+struct golden_entry {
+    int frame;
+    int width;
+    int height;
+    unsigned long hash[2];
+};
+
+struct golden {
+    const char* dir;
+    int tolerance;
+    int count;
+    int capacity;
+    int identical;
+    int matched;
+    int recorded;
+    int failed;
+    struct golden_entry* entries;
+};
+
+struct check {
+    FILE* file;
+    int index;
+};
+
+struct diagnostic {
+    int index;
+    int order;
+    int line;
+    int column;
+    int common;
+    char* message;
+};
+
+struct tiler {
+    int size;
+    int width;
+    int height;
+    unsigned int format;
+    int failed;
+    const char* path;
+    FILE* file;
+    unsigned char* rows;
+    unsigned char* line;
+    unsigned char* idat;
+    z_stream zs;
+};
+
 static struct glook {
     struct glook_opts {
         unsigned int dperf;
         unsigned int limit;
         unsigned int mode;
         unsigned int autoreload;
+        unsigned int headless;
+        unsigned int bench;
+        unsigned int nocache;
+        unsigned int fps;
+        unsigned int tile;
+        unsigned int spp;
+        unsigned int tolerance;
+        int frames[2];
     } opts;
     GLFWwindow* window;
+#ifndef __APPLE__
+    EGLDisplay egldisplay;
+    EGLContext eglcontext;
+    EGLSurface eglsurface;
+#endif
     unsigned int width, height, vshader;
+    int parallel;
+    int binaries;
+    double resized;
     int filecount;
     char* filepaths[GLOOK_FILE_COUNT];
+    char cachedir[BUFSIZE];
     struct pipeline pipeline;
     struct shader shaderpass;
+    struct state state;
+    struct pool pool;
+    struct readback readback;
+    struct golden golden;
+    struct tiler tiler;
+    struct framebuffer accum;
+    struct check check;
+    struct compiler compiler;
+    struct loader loader;
+    struct ubuffer ubuffer;
+    struct dynres dynres;
+    struct trace trace;
+    struct stats framestats;
+    struct stats swapstats;
     char keys[GLOOK_KEYBOARD_COUNT];
     char keys_pressed[GLOOK_KEYBOARD_COUNT];
     short int mouse[2];
@@ -207,14 +646,89 @@ static char* glook_strdup(const char* src)
     return ret;
 }
 
+/* two lane FNV-1a style hash over 32 bit words, portable to any long width */
+
+static void glook_hash_init(unsigned long* hash)
+{
+    hash[0] = 2166136261UL;
+    hash[1] = 3323198485UL;
+}
+
+static void glook_hash_update(unsigned long* hash, const void* data, const size_t size)
+{
+    size_t i;
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (i = 0; i < size; ++i) {
+        hash[0] = ((hash[0] ^ bytes[i]) * 16777619UL) & 0xFFFFFFFFUL;
+        hash[1] = ((hash[1] ^ bytes[i]) * 1540483477UL) & 0xFFFFFFFFUL;
+        hash[1] ^= hash[1] >> 15;
+    }
+}
+
+static void glook_hash_string(unsigned long* hash, const char* str)
+{
+    glook_hash_init(hash);
+    glook_hash_update(hash, str, strlen(str));
+}
+
+static int glook_hash_equal(const unsigned long* a, const unsigned long* b)
+{
+    return a[0] == b[0] && a[1] == b[1];
+}
+
+/* time measurement and rolling statistics */
+
+static double glook_clock(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void glook_sleep(const double seconds)
+{
+    struct timespec ts;
+    ts.tv_sec = (time_t)seconds;
+    ts.tv_nsec = (long)((seconds - (double)ts.tv_sec) * 1e9);
+    nanosleep(&ts, NULL);
+}
+
+static void glook_stats_push(struct stats* stats, const float sample)
+{
+    stats->samples[stats->head] = sample;
+    stats->head = (stats->head + 1) % GLOOK_STATS_COUNT;
+    stats->count += stats->count < GLOOK_STATS_COUNT;
+}
+
+static float glook_stats_get(const struct stats* stats, float* min, float* max)
+{
+    int i;
+    float sum = 0.0F;
+    *min = *max = stats->count ? stats->samples[0] : 0.0F;
+    for (i = 0; i < stats->count; ++i) {
+        const float f = stats->samples[i];
+        *min = f < *min ? f : *min;
+        *max = f > *max ? f : *max;
+        sum += f;
+    }
+    return stats->count ? sum / (float)stats->count : 0.0F;
+}
+
 /* error and logging */
 
+static FILE* glook_log_stream(void)
+{
+    /* keep stdout clean while frames are streamed through it */
+    return glook.readback.file == stdout ? stderr : stdout;
+}
+
 static void glook_log(const char* fmt, ...)
 {
     va_list args;
+    FILE* stream = glook_log_stream();
     va_start(args, fmt);
-    fprintf(stdout, COLBLD "glook: " COLNRM);
-    vfprintf(stdout, fmt, args);
+    fprintf(stream, COLBLD "glook: " COLNRM);
+    vfprintf(stream, fmt, args);
     va_end(args);
 }
 
@@ -228,38 +742,70 @@ static void glook_error_log(const char* fmt, ...)
     va_end(args);
 }
 
+static char* glook_compile_error_parse(char* line, int* linenum, int* column)
+{
+    int source, n = 0;
+    if (!strncmp(line, "ERROR: ", 7)) {
+        line += 7;
+    }
+
+    /* mesa writes '0:12(5): error: ..', others 'ERROR: 0:12: ..' or '0(12) : error C0000: ..' */
+    *column = 0;
+    if (sscanf(line, "%d:%d(%d)%n", &source, linenum, column, &n) == 3 ||
+        sscanf(line, "%d:%d%n", &source, linenum, &n) == 2 ||
+        sscanf(line, "%d(%d)%n", &source, linenum, &n) == 2) {
+        line += n;
+    } else *linenum = *column = 0;
+
+    while (*line == ':' || *line == ' ') {
+        ++line;
+    }
+    if (!strncmp(line, "error", 5) && strchr(line, ':')) {
+        line = strchr(line, ':') + 1;
+        while (*line == ' ') {
+            ++line;
+        }
+    }
+    line[0] = (char)tolower((unsigned char)line[0]);
+    return line;
+}
+
+static void glook_compile_error_print(
+    const char* path, const int linenum, const int column, const char* message)
+{
+    if (!linenum) {
+        fprintf(stderr, COLBLD "%s: ", path);
+    } else if (!column) {
+        fprintf(stderr, COLBLD "%s:%d: ", path, linenum);
+    } else fprintf(stderr, COLBLD "%s:%d:%d: ", path, linenum, column);
+    fprintf(stderr, COLRED "error: " COLNRM COLBLD "%s\n" COLNRM, message);
+}
+
 static void glook_compile_error_log_line(
     char* line, const char* filebuf, const char* fpath, const struct common* common)
 {
-    int i, j, n, linenum;
-    line += 7; /* remove 'ERROR: ' part from error string */
-    if (sscanf(line, "%d:%d%n", &j, &linenum, &i) < 2) {
-        line[0] = tolower(line[0]);
-        fprintf(stderr, COLBLD "%s: " COLRED "error: " COLNRM COLBLD "%s\n" COLNRM,
-            fpath, line
+    int i, j, linenum, column;
+    const char* message = glook_compile_error_parse(line, &linenum, &column);
+    const int n = linenum && linenum <= (int)common->linecount;
+    const char* path = n && common->path ? common->path : fpath;
+    const int local = n ? linenum - GLOOK_COMMON_LINE_COUNT : linenum - (int)common->linecount;
+    if (glook.check.file) {
+        fprintf(glook.check.file, "D %d %d %d %d %s\n",
+            glook.check.index, linenum ? local : 0, column, n, message
         );
         return;
     }
-    
-    line += i + 2;
-    line[0] = tolower(line[0]);
-    n = linenum < (int)common->linecount;
-    fprintf(
-        stderr, 
-        COLBLD "%s:%d:%d: " COLRED "error: " COLNRM COLBLD "%s\n" COLNRM,
-        n ? common->path : fpath, j,
-        n ? linenum - GLOOK_COMMON_LINE_COUNT : linenum - (int)common->linecount, line
-    );
-    
-    for (i = 1; i < linenum; ++i) {
-        for (++j; filebuf[j] != '\n' && filebuf[j] != '\r'; ++j) {
-            if (!filebuf[j]) {
-                return;
-            }
-        }
+
+    glook_compile_error_print(path, linenum ? local : 0, column, message);
+    if (!linenum) {
+        return;
     }
 
-    for (++j; filebuf[j] && filebuf[j] != '\n' && filebuf[j] != '\r'; ++j) {
+    /* echo the offending line of the assembled source */
+    for (i = 1, j = 0; i < linenum && filebuf[j]; ++j) {
+        i += filebuf[j] == '\n';
+    }
+    for (; filebuf[j] && filebuf[j] != '\n' && filebuf[j] != '\r'; ++j) {
         fputc(filebuf[j], stderr);
     }
     fputc('\n', stderr);
@@ -276,6 +822,163 @@ static void glook_compile_error_log(
     }
 }
 
+/* chrome://tracing and perfetto compatible timeline */
+
+static void glook_trace_string(FILE* file, const char* str)
+{
+    fputc('"', file);
+    for (; *str; ++str) {
+        if (*str == '"' || *str == '\\') {
+            fputc('\\', file);
+        }
+        if ((unsigned char)*str >= ' ') {
+            fputc(*str, file);
+        }
+    }
+    fputc('"', file);
+}
+
+static void glook_trace_event(
+    const char* name, const int tid, const double start, const double duration)
+{
+    FILE* file = glook.trace.file;
+    if (!file) {
+        return;
+    }
+
+    fprintf(file, ",\n{\"name\":");
+    glook_trace_string(file, name ? name : "glook");
+    fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+        tid, (start - glook.trace.start) * 1e6, duration * 1e6
+    );
+}
+
+static void glook_trace_span(const char* name, const char* arg, const double start)
+{
+    FILE* file = glook.trace.file;
+    if (!file) {
+        return;
+    }
+
+    fprintf(file, ",\n{\"name\":");
+    glook_trace_string(file, name);
+    fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+        GLOOK_TRACE_CPU, (start - glook.trace.start) * 1e6, (glook_clock() - start) * 1e6
+    );
+
+    if (arg) {
+        fprintf(file, ",\"args\":{\"file\":");
+        glook_trace_string(file, arg);
+        fputc('}', file);
+    }
+    fputc('}', file);
+}
+
+static int glook_trace_create(struct trace* trace, const char* path)
+{
+    trace->file = fopen(path, "w");
+    if (!trace->file) {
+        glook_error_log("could not open trace file '%s'\n", path);
+        return EXIT_FAILURE;
+    }
+
+    trace->start = glook_clock();
+    fprintf(trace->file, "[\n"
+        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+        "\"args\":{\"name\":\"cpu\"}},\n"
+        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+        "\"args\":{\"name\":\"gpu\"}}",
+        GLOOK_TRACE_CPU, GLOOK_TRACE_GPU
+    );
+    return EXIT_SUCCESS;
+}
+
+static void glook_trace_calibrate(struct trace* trace)
+{
+    /* gpu timestamps are mapped onto the cpu clock through one shared instant */
+    GLint64 stamp = 0;
+    glGetInteger64v(GL_TIMESTAMP, &stamp);
+    trace->gpuclock = glook_clock();
+    trace->gpustamp = stamp;
+}
+
+static void glook_trace_free(struct trace* trace)
+{
+    if (trace->file) {
+        fprintf(trace->file, "\n]\n");
+        fclose(trace->file);
+    }
+    memset(trace, 0, sizeof(struct trace));
+}
+
+/* double buffered GPU timer queries, results are read one frame late */
+
+static void glook_timer_collect(
+    struct timer* timer, const int i, const char* name, const int wait)
+{
+    int available = wait;
+    if (!wait) {
+        glGetQueryObjectiv(timer->queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+    }
+
+    /* the first query also times the lazy setup of a fresh target, drop it */
+    if (available && timer->samples++) {
+        GLuint64 ns, stamp = 0;
+        glGetQueryObjectui64v(timer->queries[i], GL_QUERY_RESULT, &ns);
+        timer->last = (float)((double)ns * 1e-6);
+        glook_stats_push(&timer->stats, timer->last);
+        if (glook.trace.file) {
+            /* spans start when the gpu reached the pass, so they never overlap */
+            glGetQueryObjectui64v(timer->stamps[i], GL_QUERY_RESULT, &stamp);
+            glook_trace_event(name, GLOOK_TRACE_GPU, glook.trace.gpuclock +
+                (double)((GLint64)stamp - glook.trace.gpustamp) * 1e-9, (double)ns * 1e-9
+            );
+        }
+    }
+    timer->pending[i] = 0;
+}
+
+static void glook_timer_begin(struct timer* timer, const char* name)
+{
+    const int i = timer->index;
+    if (!timer->queries[0]) {
+        glGenQueries(2, timer->queries);
+        glGenQueries(2, timer->stamps);
+    }
+
+    if (timer->pending[i]) {
+        glook_timer_collect(timer, i, name, 0);
+    }
+
+    if (glook.trace.file) {
+        glQueryCounter(timer->stamps[i], GL_TIMESTAMP);
+    }
+    glBeginQuery(GL_TIME_ELAPSED, timer->queries[i]);
+}
+
+static void glook_timer_end(struct timer* timer)
+{
+    glEndQuery(GL_TIME_ELAPSED);
+    timer->pending[timer->index] = 1;
+    timer->index = !timer->index;
+}
+
+static void glook_timer_free(struct timer* timer, const char* name)
+{
+    int i;
+    if (timer->queries[0]) {
+        /* results still in flight are waited on so the trace ends with every pass */
+        for (i = 0; i < 2; ++i) {
+            const int j = (timer->index + i) % 2;
+            if (timer->pending[j]) {
+                glook_timer_collect(timer, j, name, 1);
+            }
+        }
+        glDeleteQueries(2, timer->queries);
+        glDeleteQueries(2, timer->stamps);
+    }
+}
+
 /* basic file io */
 
 static int glook_file_write(const char* fpath, const char* filebuf)
@@ -331,13 +1034,23 @@ static char* glook_file_read(const char* fpath, const size_t offset)
     return buffer;
 }
 
+static int glook_mkdir(const char* path)
+{
+    if (mkdir(path, 0755) && errno != EEXIST) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
 static char* glook_file_shader_read(const char* fpath, const struct common* common)
 {
+    const double t = glook_clock();
     char* source = glook_file_read(fpath, common->length);
     if (source) {   
         memcpy(source, common->source, common->length);
     }
-    
+
+    glook_trace_span("read", fpath, t);
     return source;
 }
 
@@ -370,9 +1083,32 @@ static struct common glook_common_create(char* path)
             );
         }
     }
+
+    glook_hash_string(common.hash, common.source);
     return common;
 }
 
+static int glook_common_reload(struct common* common)
+{
+    struct common reload;
+    if (!common->path) {
+        return EXIT_SUCCESS;
+    }
+
+    reload = glook_common_create(common->path);
+    if (!reload.path) {
+        return EXIT_FAILURE;
+    }
+
+    if (glook_hash_equal(reload.hash, common->hash)) {
+        free(reload.source);
+    } else {
+        free(common->source);
+        *common = reload;
+    }
+    return EXIT_SUCCESS;
+}
+
 static void glook_common_free(struct common* common)
 {
     if (common->path) {
@@ -385,29 +1121,16 @@ static void glook_common_free(struct common* common)
 
 /* runtime shader compiling */
 
-static void glook_shader_free(struct shader* shader)
-{
-    if (shader->fpath) {
-        free(shader->fpath);
-    }
-    if (shader->id) {
-        glDeleteProgram(shader->id);
-    }
-    if (shader->framebuffer.fbo) {
-        glDeleteFramebuffers(1, &shader->framebuffer.fbo);
-    }
-    
-    memset(shader, 0, sizeof(struct shader));
-}
-
-static int glook_shader_compile(unsigned int shader, 
-    const char* filebuf, const char* fpath, const struct common* common)
+static int glook_shader_compile(unsigned int shader, 
+    const char* filebuf, const char* fpath, const struct common* common)
 {
     int success;
     char log[LOGSIZE];
+    const double t = glook_clock();
     glShaderSource(shader, 1, &filebuf, NULL);
     glCompileShader(shader);
     glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    glook_trace_span("compile", fpath, t);
     if (!success) {
         glGetShaderInfoLog(shader, LOGSIZE, NULL, log);
         glook_compile_error_log(log, filebuf, fpath, common);
@@ -416,738 +1139,5368 @@ static int glook_shader_compile(unsigned int shader,
     return EXIT_SUCCESS;
 }
 
-static int glook_shader_link(unsigned int shader, unsigned int fshader, 
-    const char* filebuf, const char* fpath, const struct common* common)
-{
-    int success;
-    char log[LOGSIZE];
-    glAttachShader(shader, glook.vshader);
-    glAttachShader(shader, fshader);
-    glLinkProgram(shader);
-    glGetProgramiv(shader, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetProgramInfoLog(shader, LOGSIZE, NULL, log);
-        glook_compile_error_log(log, filebuf, fpath, common);
-        return EXIT_FAILURE;
-    }
-    return EXIT_SUCCESS;
-}
-
 static struct ulocator glook_shader_ulocator_create(const unsigned int id)
 {
     int i;
-    struct tm tm;
+    unsigned int block;
     struct ulocator locator;
-    time_t t = time(NULL);
-    char channelstr[] = "iChannel0", resolutionstr[] = "iChannelResolution[0]";
+    char channelstr[] = "iChannel0";
     
-    tm = *localtime(&t);
-    locator.iTime = glGetUniformLocation(id, "iTime");
-    locator.iTimeDelta = glGetUniformLocation(id, "iTimeDelta");
-    locator.iFrame = glGetUniformLocation(id, "iFrame");
-    locator.iFrameRate = glGetUniformLocation(id, "iFrameRate");
-    locator.iDate = glGetUniformLocation(id, "iDate");
     locator.iResolution = glGetUniformLocation(id, "iResolution");
-    locator.iMouse = glGetUniformLocation(id, "iMouse");
-
     for (i = 0; i < GLOOK_INPUT_COUNT; ++i) {
-        char c = i + '0';
-        channelstr[8] = c;
-        resolutionstr[19] = c;
+        channelstr[8] = i + '0';
         locator.iChannels[i] = glGetUniformLocation(id, channelstr);
-        locator.iChannelResolution[i] = glGetUniformLocation(id, resolutionstr);
         glUniform1i(locator.iChannels[i], i);
-        glUniform3f(
-            locator.iChannelResolution[i], 
-            (float)(glook.width * GLOOK_SCALE),
-            (float)(glook.height * GLOOK_SCALE),
-            1.0F
-        );
     }
 
-    glUniform3f(
-            locator.iResolution,
-            (float)(glook.width * GLOOK_SCALE),
-            (float)(glook.height * GLOOK_SCALE),
-            1.0F
-    );
-
-    glUniform4f(
-        locator.iDate, 
-        (float)(tm.tm_year + 1900),
-        (float)(tm.tm_mon + 1),
-        (float)tm.tm_mday,
-        (float)tm.tm_hour
-    );
+    /* the shadertoy globals live in uniform blocks shared through fixed bindings */
+    block = glGetUniformBlockIndex(id, "_glookFrame");
+    if (block != GL_INVALID_INDEX) {
+        glUniformBlockBinding(id, block, GLOOK_UBO_FRAME);
+    }
+    block = glGetUniformBlockIndex(id, "_glookPass");
+    if (block != GL_INVALID_INDEX) {
+        glUniformBlockBinding(id, block, GLOOK_UBO_PASS);
+    }
     
     return locator;
 }
 
+/* per frame uniform buffer, written once and read by every pass */
+
+static void glook_ubuffer_create(struct ubuffer* ubuffer)
+{
+    ubuffer->epoch = time(NULL);
+    ubuffer->start = glook_clock();
+    glGenBuffers(1, &ubuffer->id);
+    glBindBuffer(GL_UNIFORM_BUFFER, ubuffer->id);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(struct uframe), NULL, GL_STREAM_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, GLOOK_UBO_FRAME, ubuffer->id);
+}
+
+static void glook_ubuffer_update(struct ubuffer* ubuffer,
+    const int frame, const float t, const float dt, const float* mouse)
+{
+    struct tm tm;
+    time_t secs;
+    struct uframe uframe;
+    /* fixed timesteps count from the unix epoch in utc, so every run sees the
+     * same date and frames stay reproducible across runs and machines */
+    const double now = ubuffer->live ?
+        (double)ubuffer->epoch + glook_clock() - ubuffer->start : (double)t;
+    
+    secs = (time_t)now;
+    tm = ubuffer->live ? *localtime(&secs) : *gmtime(&secs);
+    memcpy(uframe.iMouse, mouse, sizeof(uframe.iMouse));
+    uframe.iDate[0] = (float)(tm.tm_year + 1900);
+    uframe.iDate[1] = (float)(tm.tm_mon + 1);
+    uframe.iDate[2] = (float)tm.tm_mday;
+    uframe.iDate[3] = (float)(tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec) +
+        (float)(now - floor(now));
+    uframe.iTime = t;
+    uframe.iTimeDelta = dt;
+    uframe.iFrameRate = 1.0F / dt;
+    uframe.iFrame = frame;
+
+    /* orphan the storage so the driver never stalls on last frame's draws */
+    glBindBuffer(GL_UNIFORM_BUFFER, ubuffer->id);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(struct uframe), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(struct uframe), &uframe);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+static void glook_ubuffer_free(struct ubuffer* ubuffer)
+{
+    if (ubuffer->id) {
+        glDeleteBuffers(1, &ubuffer->id);
+    }
+}
+
+/* opengl binding cache, redundant state changes never reach the driver */
+
+static void glook_state_program(const unsigned int id)
+{
+    if (glook.state.program != id) {
+        glUseProgram(id);
+        glook.state.program = id;
+    }
+}
+
+static void glook_state_framebuffer(const unsigned int target, const unsigned int fbo)
+{
+    struct state* state = &glook.state;
+    const int draw = target != GL_READ_FRAMEBUFFER, read = target != GL_DRAW_FRAMEBUFFER;
+    if ((draw && state->draw != fbo) || (read && state->read != fbo)) {
+        glBindFramebuffer(target, fbo);
+        if (draw) {
+            state->draw = fbo;
+        }
+        if (read) {
+            state->read = fbo;
+        }
+    }
+}
+
+static void glook_state_viewport(const int width, const int height)
+{
+    int* viewport = glook.state.viewport;
+    if (viewport[0] != width || viewport[1] != height) {
+        glViewport(0, 0, width, height);
+        viewport[0] = width;
+        viewport[1] = height;
+    }
+}
+
+static void glook_state_texture(const unsigned int unit, const unsigned int id)
+{
+    struct state* state = &glook.state;
+    if (state->textures[unit] == id) {
+        return;
+    }
+
+    if (state->unit != unit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        state->unit = unit;
+    }
+    glBindTexture(GL_TEXTURE_2D, id);
+    state->textures[unit] = id;
+}
+
+static void glook_state_forget(const struct framebuffer* fb)
+{
+    int i;
+    struct state* state = &glook.state;
+    /* gl unbinds deleted objects and may hand their names out again */
+    if (state->draw == fb->fbo) {
+        state->draw = 0;
+    }
+    if (state->read == fb->fbo) {
+        state->read = 0;
+    }
+    for (i = 0; i < GLOOK_INPUT_COUNT; ++i) {
+        if (state->textures[i] == fb->texture.id) {
+            state->textures[i] = 0;
+        }
+    }
+}
+
 /* framebuffer to texture */
 
-static struct texture glook_texture_framebuffer(void)
+static const struct format {
+    const char* name;
+    unsigned int internal;
+    unsigned int layout;
+    unsigned int type;
+} glook_formats[] = {
+    {"rgba8", GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE},
+    {"rgba16f", GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT},
+    {"r32f", GL_R32F, GL_RED, GL_FLOAT},
+    {"rgba32f", GL_RGBA32F, GL_RGBA, GL_FLOAT}
+};
+
+static const struct format* glook_format_get(const unsigned int internal)
+{
+    size_t i;
+    for (i = 0; i < sizeof(glook_formats) / sizeof(glook_formats[0]); ++i) {
+        if (glook_formats[i].internal == internal) {
+            return glook_formats + i;
+        }
+    }
+    return glook_formats + 3;
+}
+
+static unsigned int glook_format_find(const char* name)
+{
+    size_t i;
+    for (i = 0; i < sizeof(glook_formats) / sizeof(glook_formats[0]); ++i) {
+        if (!strcmp(glook_formats[i].name, name)) {
+            return glook_formats[i].internal;
+        }
+    }
+    return 0;
+}
+
+static struct texture glook_texture_framebuffer(
+    const int width, const int height, const unsigned int format)
 {
     struct texture texture;
+    const struct format* f = glook_format_get(format);
     glGenTextures(1, &texture.id);
-    glfwGetFramebufferSize(glook.window, &texture.width, &texture.height);
-    glBindTexture(GL_TEXTURE_2D, texture.id);
+    texture.format = format;
+    texture.width = width;
+    texture.height = height;
+    glook_state_texture(glook.state.unit, texture.id);
     glTexImage2D(
-        GL_TEXTURE_2D, 0, GL_RGBA32F, texture.width, texture.height,
-        0, GL_RGBA, GL_FLOAT, NULL
+        GL_TEXTURE_2D, 0, format, texture.width, texture.height,
+        0, f->layout, f->type, NULL
     );
     
+    /* single channel targets read back as grey like in the shadertoy buffers */
+    if (f->layout == GL_RED) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_RED);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, GL_ONE);
+    }
+
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    /* targets are sampled with linear minification only, so no levels are allocated,
+     * they would be undefined and cost another third of every target */
     glFramebufferTexture2D(
         GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture.id, 0
     );
-    
-    glGenerateMipmap(GL_TEXTURE_2D);
     return texture;
 }
 
-static struct framebuffer glook_framebuffer_create(void)
+static struct framebuffer glook_framebuffer_create(
+    const int width, const int height, const unsigned int format)
 {
     struct framebuffer fb;
     glGenFramebuffers(1, &fb.fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, fb.fbo);
-    fb.texture = glook_texture_framebuffer();    
+    glook_state_framebuffer(GL_FRAMEBUFFER, fb.fbo);
+    fb.texture = glook_texture_framebuffer(width, height, format);
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
         glook_error_log("failed to create framebuffer render object\n");
+        glook_state_forget(&fb);
+        glDeleteFramebuffers(1, &fb.fbo);
         fb.fbo = 0;
     }
-
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
     return fb;
 }
 
-static struct shader glook_shader_load_buffer(
-    const char* buf, char* fpath, const struct common* common)
+static void glook_framebuffer_free(struct framebuffer* fb)
 {
-    unsigned int fshader;
-    struct shader shader = {0};
-    shader.id = glCreateProgram();
-    fshader = glCreateShader(GL_FRAGMENT_SHADER);
-    if (glook_shader_compile(fshader, buf, fpath, common) ||
-        glook_shader_link(shader.id, fshader, buf, fpath, common)) {
-        glook_shader_free(&shader);
-    } else {
-        glUseProgram(shader.id);
-        shader.fpath = fpath;
-        shader.locator = glook_shader_ulocator_create(shader.id);
-        shader.framebuffer = glook_framebuffer_create();
+    glook_state_forget(fb);
+    if (fb->fbo) {
+        glDeleteFramebuffers(1, &fb->fbo);
     }
-
-    glDeleteShader(fshader);
-    return shader;
+    if (fb->texture.id) {
+        glDeleteTextures(1, &fb->texture.id);
+    }
+    memset(fb, 0, sizeof(struct framebuffer));
 }
 
-static struct shader glook_shader_load(char* fpath, struct common* common)
+/* render target pool, released targets are handed out again by size and format */
+
+static struct framebuffer glook_pool_acquire(
+    struct pool* pool, const int width, const int height, const unsigned int format)
 {
-    char* filebuf;
-    struct shader shader = {0};
-    filebuf = glook_file_shader_read(fpath, common);
-    if (filebuf) {
-        shader = glook_shader_load_buffer(filebuf, fpath, common);
-        free(filebuf);
+    int i;
+    struct framebuffer fb;
+    for (i = pool->count - 1; i >= 0; --i) {
+        fb = pool->framebuffers[i];
+        if (fb.texture.width == width && fb.texture.height == height &&
+            fb.texture.format == format) {
+            pool->framebuffers[i] = pool->framebuffers[--pool->count];
+            return fb;
+        }
     }
-
-    return shader;
+    return glook_framebuffer_create(width, height, format);
 }
 
-static int glook_shader_reload(struct shader* shader)
+static void glook_pool_release(struct pool* pool, struct framebuffer* fb)
 {
-    struct shader reload = glook_shader_load(shader->fpath, &shader->pipeline->common);
-    if (reload.id) {
-        reload.inputcount = shader->inputcount;
-        memcpy(reload.inputs, shader->inputs, sizeof(reload.inputs));
-        reload.pipeline = shader->pipeline;
-        shader->fpath = NULL;
-        glook_shader_free(shader);
-        *shader = reload;
+    if (!fb->fbo) {
+        glook_framebuffer_free(fb);
+        return;
     }
-    return !reload.id;
-}
 
-/* pipeline shader utils */
-
-static struct shader* glook_pipeline_head(struct pipeline* pipeline)
-{
-    return pipeline->shaders + MIN(pipeline->count - 1, (int)glook.opts.limit);
+    if (pool->count == GLOOK_POOL_COUNT) {
+        glook_framebuffer_free(pool->framebuffers);
+        memmove(pool->framebuffers, pool->framebuffers + 1,
+            (GLOOK_POOL_COUNT - 1) * sizeof(struct framebuffer)
+        );
+        --pool->count;
+    }
+    pool->framebuffers[pool->count++] = *fb;
+    memset(fb, 0, sizeof(struct framebuffer));
 }
 
-static struct texture* glook_shader_input_texture(struct input input)
+static void glook_pool_trim(struct pool* pool, const int width, const int height)
 {
-    switch (input.type) {
-        case GLOOK_FRAMEBUFFER:
-            return &((struct shader*)input.data)->framebuffer.texture;
-        case GLOOK_TEXTURE: break;
+    int i, count = 0;
+    for (i = 0; i < pool->count; ++i) {
+        struct framebuffer* fb = pool->framebuffers + i;
+        if (fb->texture.width == width && fb->texture.height == height) {
+            pool->framebuffers[count++] = *fb;
+        } else glook_framebuffer_free(fb);
     }
+    pool->count = count;
+}
 
-    glook_error_log("invalid input type with value: %d\n", input.type);
-    return NULL;
+static void glook_pool_free(struct pool* pool)
+{
+    glook_pool_trim(pool, 0, 0);
 }
 
-static void glook_shader_render_self(struct shader* shader)
-{ 
-    const int w = glook.width * GLOOK_SCALE, h = glook.height * GLOOK_SCALE;
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, shader->framebuffer.fbo);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, glook.shaderpass.framebuffer.fbo);
-    glBlitFramebuffer(0, 0, w, h, 0, 0, w, h, GL_COLOR_BUFFER_BIT, GL_LINEAR);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-}
-
-static void glook_shader_render(
-    struct shader* shader, int frame, float t, float dt, float fps, float* mouse)
-{
-    int i, self = -1;
-    const int inputcount = shader->inputcount;
-    for (i = 0; i < inputcount; ++i) {
-        if (shader->inputs[i].type == GLOOK_FRAMEBUFFER) {
-            struct shader* inshader = shader->inputs[i].data;
-            if (!inshader->rendered) {
-                if (inshader == shader) {
-                    glook_shader_render_self(inshader);
-                    self = i;
-                } else {
-                    glook_shader_render(inshader, frame, t, dt, fps, mouse);
-                }
-            }
-        }
+static int glook_framebuffer_realloc(struct framebuffer* fb,
+    const int width, const int height, const unsigned int format)
+{
+    struct framebuffer resized;
+    if (!fb->fbo || (fb->texture.width == width && fb->texture.height == height &&
+        fb->texture.format == format)) {
+        return EXIT_SUCCESS;
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, shader->framebuffer.fbo);
-    for (i = 0; i < inputcount; ++i) {
-        struct texture* texture = glook_shader_input_texture(shader->inputs[i]);
-        glActiveTexture(GL_TEXTURE0 + i);
-        glBindTexture(
-            GL_TEXTURE_2D,
-            self != i ? texture->id : glook.shaderpass.framebuffer.texture.id
+    /* stretch the previous contents so feedback passes carry on after a resize */
+    resized = glook_pool_acquire(&glook.pool, width, height, format);
+    if (resized.fbo) {
+        glook_state_framebuffer(GL_READ_FRAMEBUFFER, fb->fbo);
+        glook_state_framebuffer(GL_DRAW_FRAMEBUFFER, resized.fbo);
+        glBlitFramebuffer(
+            0, 0, fb->texture.width, fb->texture.height, 0, 0, width, height,
+            GL_COLOR_BUFFER_BIT, GL_LINEAR
         );
+        glook_pool_release(&glook.pool, fb);
+        *fb = resized;
     }
-
-    glClear(GL_COLOR_BUFFER_BIT);
-    glUseProgram(shader->id);
-    glUniform1f(shader->locator.iTime, t);
-    glUniform1f(shader->locator.iTimeDelta, dt);
-    glUniform1i(shader->locator.iFrame, frame);
-    glUniform1f(shader->locator.iFrameRate, fps);
-    glUniform4f(shader->locator.iMouse, mouse[0], mouse[1], mouse[2], mouse[3]);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    ++shader->rendered;
+    return resized.fbo ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
-/* pipeline and shader arrays */
+/* '#pragma glook <key>(<value>)' lines carry per pass settings inside the source */
 
-static struct input glook_shader_input(void *data)
+static int glook_shader_pragma(const char* source, const char* key, char* value)
 {
-    struct input input;
-    input.type = GLOOK_FRAMEBUFFER;
-    input.data = data;
-    return input;
+    const size_t len = strlen(key);
+    while ((source = strstr(source, "#pragma glook"))) {
+        source += 13;
+        while (*source == ' ' || *source == '\t') {
+            ++source;
+        }
+        if (!strncmp(source, key, len) && source[len] == '(' &&
+            sscanf(source + len + 1, "%31[^) \t\r\n]", value) == 1) {
+            return 1;
+        }
+    }
+    return 0;
 }
 
-static int glook_input_parse(char* fpath, char** path, char* inputs)
+/* pass resolution as a fraction of the output 'N/D' or a fixed size 'WxH' */
+
+static int glook_resolution_parse(const char* str, struct resolution* resolution)
 {
-    static const char* div = ";:,";
-    char* tok;
-    int inputcount = 0;
-    *path = strtok(fpath, div);
-    while ((tok = strtok(NULL, div))) {
-        if (inputcount >= GLOOK_INPUT_COUNT) {
-            glook_error_log(
-                "cannot link to more than %d inputs\n", GLOOK_INPUT_COUNT
-            );
-            break;
-        }
-    
-        while (*tok) {
-            if (*tok < '0' || *tok > GLOOK_SHADER_COUNT + '0') {
-                 glook_error_log(
-                    "invalid input channel %d: must be in range (0 - %d)\n", 
-                    *tok, GLOOK_SHADER_COUNT
-                );
-            } else {
-                inputs[inputcount++] = *tok;
-            }
-            ++tok;
-        }
+    int n = 0;
+    memset(resolution, 0, sizeof(struct resolution));
+    if (sscanf(str, "%d/%d%n", &resolution->num, &resolution->den, &n) == 2 && !str[n] &&
+        resolution->num > 0 && resolution->den > 0) {
+        return EXIT_SUCCESS;
     }
 
-    return inputcount;
+    n = 0;
+    memset(resolution, 0, sizeof(struct resolution));
+    if (sscanf(str, "%dx%d%n", &resolution->width, &resolution->height, &n) == 2 &&
+        !str[n] && resolution->width > 0 && resolution->height > 0) {
+        return EXIT_SUCCESS;
+    }
+
+    memset(resolution, 0, sizeof(struct resolution));
+    return EXIT_FAILURE;
 }
 
-static int glook_shader_input_connect(
-    struct shader* shader, const int index, const char* inputs, int inputcount)
+static void glook_resolution_size(
+    const struct resolution* resolution, int* width, int* height)
 {
-    int i = 1;
-    struct pipeline* pipeline = shader->pipeline;
-    if (inputcount) {
-        for (i = 0; i < inputcount; ++i) {
-            int n = inputs[i] - '0';
-            shader->inputs[i] = glook_shader_input(pipeline->shaders + n);
-        }
-    } else if (glook.opts.mode == GLOOK_MODE_CHAIN && index) {
-        shader->inputs[0] = glook_shader_input(pipeline->shaders + index - 1);
-    } else if (glook.opts.mode >= GLOOK_MODE_DIRECT) {
-        int n = glook.opts.mode - GLOOK_MODE_DIRECT;
-        shader->inputs[0] = glook_shader_input(pipeline->shaders + n); 
+    int w = glook.width * GLOOK_SCALE, h = glook.height * GLOOK_SCALE;
+    if (glook.dynres.level) {
+        w = MAX(1, w * glook.dynres.level / GLOOK_DYNRES_STEPS);
+        h = MAX(1, h * glook.dynres.level / GLOOK_DYNRES_STEPS);
+    }
+
+    if (resolution->width) {
+        *width = resolution->width;
+        *height = resolution->height;
+    } else if (resolution->den) {
+        *width = MAX(1, w * resolution->num / resolution->den);
+        *height = MAX(1, h * resolution->num / resolution->den);
     } else {
-        for (i = 0; i < index; ++i) {
-            shader->inputs[i] = glook_shader_input(pipeline->shaders + i);
-        }
+        *width = w;
+        *height = h;
     }
+}
 
-    return i;
+static struct resolution glook_shader_target(
+    const struct resolution* resolution, const char* source)
+{
+    char value[32];
+    struct resolution target = *resolution;
+    if (!target.den && !target.width && glook_shader_pragma(source, "resolution", value) &&
+        glook_resolution_parse(value, &target)) {
+        glook_error_log("invalid resolution '%s' in pragma: must be N/D or WxH\n", value);
+    }
+    return target;
 }
 
-static int glook_pipeline_push(struct pipeline* pipeline, char* fpath)
+static unsigned int glook_shader_format(const unsigned int format, const char* source)
 {
-    int inputcount;
-    struct shader shader;
-    char *path, inputs[GLOOK_INPUT_COUNT] = {0}; 
-    if (pipeline->count >= GLOOK_SHADER_COUNT) {
-        glook_error_log(
-            "cannot pipeline more than %d shaders at once\n", GLOOK_SHADER_COUNT
-        );
-        return EXIT_FAILURE;
+    char value[32];
+    unsigned int pragma;
+    if (format) {
+        return format;
     }
 
-    inputcount = glook_input_parse(fpath, &path, inputs);
-    shader = glook_shader_load(path, &pipeline->common);
-    if (shader.id) {
-        shader.pipeline = pipeline;
-        shader.inputcount = glook_shader_input_connect(
-            &shader, pipeline->count, inputs, inputcount
-        );
-        pipeline->shaders[pipeline->count++] = shader;
+    if (!glook_shader_pragma(source, "format", value)) {
+        return GL_RGBA32F;
     }
 
-    return !shader.id * 2;
+    pragma = glook_format_find(value);
+    if (!pragma) {
+        glook_error_log("unknown format '%s' in pragma, using rgba32f\n", value);
+        return GL_RGBA32F;
+    }
+    return pragma;
 }
 
-static int glook_shader_pipeline_load(
-    struct pipeline* pipeline, char* commonpath)
+/* float to 8-bit pixel conversion */
+
+static void glook_convert_rgba8_scalar(
+    unsigned char* dst, const float* src, const int count)
 {
-    int i, err = 0;
-    pipeline->common = glook_common_create(commonpath);
-    for (i = 0; i < glook.filecount; ++i) {
-        if (glook_pipeline_push(pipeline, glook.filepaths[i])) {
-            free(glook.filepaths[i]);
-            ++err;
-        } 
-        glook.filepaths[i] = NULL;
+    int i;
+    for (i = 0; i < count * 4; ++i) {
+        const float f = src[i] < 0.0F ? 0.0F : src[i] > 1.0F ? 1.0F : src[i];
+        dst[i] = (unsigned char)(f * 255.0F + 0.5F);
+    }
+    for (i = 3; i < count * 4; i += 4) {
+        dst[i] = 0xFF;
     }
-    glook.filecount = 0;
-    return err;
 }
 
-static int glook_shader_pipeline_reload(struct pipeline* pipeline)
+#ifdef GLOOK_SIMD_X86
+
+/* same rounding as the scalar path, add a half and truncate, so output bytes
+ * never depend on the image width or on which instruction set is available */
+static __m128i glook_convert_sse2(const float* p)
 {
-    int i, err = 0;
-    for (i = 0; i < pipeline->count; ++i) {
-        err += glook_shader_reload(pipeline->shaders + i);
-    }
-    return err;
+    const __m128 f = _mm_min_ps(
+        _mm_max_ps(_mm_loadu_ps(p), _mm_setzero_ps()), _mm_set1_ps(1.0F)
+    );
+    return _mm_cvttps_epi32(
+        _mm_add_ps(_mm_mul_ps(f, _mm_set1_ps(255.0F)), _mm_set1_ps(0.5F))
+    );
 }
 
-static void glook_shader_pipeline_clear(struct pipeline* pipeline)
+static void glook_convert_rgba8_sse2(unsigned char* dst, const float* src, const int count)
 {
     int i;
-    for (i = 0; i < pipeline->count; ++i) {
-        pipeline->shaders[i].rendered = 0;
+    const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+    for (i = 0; i + 4 <= count; i += 4) {
+        const float* p = src + i * 4;
+        __m128i a, b, c, d;
+        a = glook_convert_sse2(p);
+        b = glook_convert_sse2(p + 4);
+        c = glook_convert_sse2(p + 8);
+        d = glook_convert_sse2(p + 12);
+        a = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        _mm_storeu_si128((__m128i*)(dst + i * 4), _mm_or_si128(a, alpha));
     }
+    glook_convert_rgba8_scalar(dst + i * 4, src + i * 4, count - i);
 }
 
-static void glook_shader_pipeline_free(struct pipeline* pipeline)
+__attribute__((target("avx2")))
+static __m256i glook_convert_avx2(const float* p)
 {
-    int i;
-    for (i = 0; i < pipeline->count; ++i) {
-        glook_shader_free(pipeline->shaders + i);
-    }
-    
-    glook_common_free(&pipeline->common);
-    memset(pipeline, 0, sizeof(struct pipeline));
+    const __m256 f = _mm256_min_ps(
+        _mm256_max_ps(_mm256_loadu_ps(p), _mm256_setzero_ps()), _mm256_set1_ps(1.0F)
+    );
+    return _mm256_cvttps_epi32(
+        _mm256_add_ps(_mm256_mul_ps(f, _mm256_set1_ps(255.0F)), _mm256_set1_ps(0.5F))
+    );
 }
 
-static void glook_shader_pipeline_render(
-    struct pipeline* pipeline, int frame, float t, float dt, float* mouse)
+__attribute__((target("avx2")))
+static void glook_convert_rgba8_avx2(unsigned char* dst, const float* src, const int count)
 {
-    struct shader* shader = glook_pipeline_head(pipeline);
-    glook_shader_render(shader, frame, t, dt, 1.0 / dt, mouse);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, shader->framebuffer.texture.id);
-    glClear(GL_COLOR_BUFFER_BIT);
-    glUseProgram(glook.shaderpass.id);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    glUseProgram(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    int i;
+    const __m256i alpha = _mm256_set1_epi32((int)0xFF000000);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    for (i = 0; i + 8 <= count; i += 8) {
+        const float* p = src + i * 4;
+        __m256i a, b, c, d;
+        a = glook_convert_avx2(p);
+        b = glook_convert_avx2(p + 8);
+        c = glook_convert_avx2(p + 16);
+        d = glook_convert_avx2(p + 24);
+        /* packs work within 128-bit lanes, pixels come out as 0 2 4 6 1 3 5 7 */
+        a = _mm256_packus_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+        a = _mm256_permutevar8x32_epi32(a, order);
+        _mm256_storeu_si256((__m256i*)(dst + i * 4), _mm256_or_si256(a, alpha));
+    }
+    glook_convert_rgba8_sse2(dst + i * 4, src + i * 4, count - i);
 }
 
-/* mouse control functions */
+#endif /* GLOOK_SIMD_X86 */
 
-static unsigned int glook_mouse_down(unsigned int button)
+static void glook_convert_rgba8(
+    unsigned char* dst, const float* src, const int width, const int height)
 {
-    return glook.mouse[button];
+    int y;
+    void (*convert)(unsigned char*, const float*, const int) = glook_convert_rgba8_scalar;
+#ifdef GLOOK_SIMD_X86
+    convert = __builtin_cpu_supports("avx2") ? 
+        glook_convert_rgba8_avx2 : glook_convert_rgba8_sse2;
+#endif
+
+    /* alpha is forced opaque like the present pass, rows flipped to top-down */
+    for (y = 0; y < height; ++y) {
+        convert(dst + (height - 1 - y) * width * 4, src + y * width * 4, width);
+    }
 }
 
-static unsigned int glook_mouse_pressed(unsigned int button)
+static void glook_convert_grey8(unsigned char* dst, const void* src,
+    const int width, const int height, const unsigned int type, const int flip)
 {
-    unsigned int held = glfwGetMouseButton(glook.window, button);
-    unsigned int pressed = (held == GLFW_PRESS && glook.mouse[button] == GLFW_RELEASE);
-    glook.mouse[button] = held;
-    return pressed;
+    int x, y;
+    for (y = 0; y < height; ++y) {
+        unsigned char* row = dst + (flip ? height - 1 - y : y) * width * 4;
+        for (x = 0; x < width; ++x) {
+            unsigned char v;
+            if (type == GL_FLOAT) {
+                const float f = ((const float*)src)[y * width + x];
+                v = (unsigned char)((f < 0.0F ? 0.0F : f > 1.0F ? 1.0F : f) * 255.0F + 0.5F);
+            } else v = ((const unsigned char*)src)[y * width + x];
+            row[x * 4 + 0] = row[x * 4 + 1] = row[x * 4 + 2] = v;
+            row[x * 4 + 3] = 0xFF;
+        }
+    }
 }
 
-static void glook_mouse_pos(float* x, float* y)
+static void glook_convert_pixels(unsigned char* dst, const void* src, const int width,
+    const int height, const unsigned int layout, const unsigned int type)
 {
-    double mx, my, scale = (float)GLOOK_SCALE;
-    glfwGetCursorPos(glook.window, &mx, &my);
-    *x = (float)mx * scale;
-    *y = (float)(glook.height - (float)my) * scale;
+    int y;
+    if (layout == GL_RED) {
+        glook_convert_grey8(dst, src, width, height, type, 1);
+    } else if (type == GL_FLOAT) {
+        glook_convert_rgba8(dst, (const float*)src, width, height);
+    } else {
+        for (y = 0; y < height; ++y) {
+            unsigned char* row = dst + (height - 1 - y) * width * 4;
+            int x;
+            memcpy(row, (const unsigned char*)src + y * width * 4, width * 4);
+            for (x = 3; x < width * 4; x += 4) {
+                row[x] = 0xFF;
+            }
+        }
+    }
 }
 
-static void glook_mouse_get(float* mouse)
+/* image file encoding */
+
+static void glook_png_chunk(
+    FILE* file, const char* type, const unsigned char* data, const size_t size)
 {
-    int pressed = glook_mouse_pressed(GLFW_MOUSE_BUTTON_LEFT);
-    int down = glook_mouse_down(GLFW_MOUSE_BUTTON_LEFT);
-    mouse[2] = (float)((down * 2 - 1) * mouse[0]);
-    mouse[3] = (float)((pressed * 2 - 1) * mouse[1]);
-    if (down) {
-        glook_mouse_pos(mouse, mouse + 1);
+    unsigned char header[8];
+    unsigned long crc = crc32(0L, (const Bytef*)type, 4);
+    if (size) {
+        crc = crc32(crc, data, (uInt)size);
     }
+    header[0] = (unsigned char)(size >> 24);
+    header[1] = (unsigned char)(size >> 16);
+    header[2] = (unsigned char)(size >> 8);
+    header[3] = (unsigned char)size;
+    memcpy(header + 4, type, 4);
+    fwrite(header, 1, 8, file);
+    fwrite(data, 1, size, file);
+    header[0] = (unsigned char)(crc >> 24);
+    header[1] = (unsigned char)(crc >> 16);
+    header[2] = (unsigned char)(crc >> 8);
+    header[3] = (unsigned char)crc;
+    fwrite(header, 1, 4, file);
 }
 
-/* keyboard control functions */
+static void glook_png_header(FILE* file, const int width, const int height)
+{
+    static const unsigned char signature[8] = {137, 'P', 'N', 'G', '\r', '\n', 26, '\n'};
+    unsigned char ihdr[13] = {0};
+    ihdr[0] = (unsigned char)(width >> 24);
+    ihdr[1] = (unsigned char)(width >> 16);
+    ihdr[2] = (unsigned char)(width >> 8);
+    ihdr[3] = (unsigned char)width;
+    ihdr[4] = (unsigned char)(height >> 24);
+    ihdr[5] = (unsigned char)(height >> 16);
+    ihdr[6] = (unsigned char)(height >> 8);
+    ihdr[7] = (unsigned char)height;
+    ihdr[8] = 8;
+    ihdr[9] = 6;
+    fwrite(signature, 1, sizeof(signature), file);
+    glook_png_chunk(file, "IHDR", ihdr, sizeof(ihdr));
+}
 
-static unsigned int glook_key_down(unsigned int key)
+static void glook_png_filter(unsigned char* row, const unsigned char* src, const int stride)
 {
-    return glook.keys[key];
+    int x;
+    row[0] = 1; /* sub filter */
+    memcpy(row + 1, src, 4);
+    for (x = 4; x < stride; ++x) {
+        row[x + 1] = (unsigned char)(src[x] - src[x - 4]);
+    }
 }
 
-static unsigned int glook_key_pressed(unsigned int key)
+static int glook_png_write(
+    FILE* file, const unsigned char* pixels, const int width, const int height)
 {
-    unsigned int pressed = glook.keys_pressed[key];
-    glook.keys_pressed[key] = 0;
-    return pressed;
+    unsigned char *filtered, *compressed;
+    const size_t stride = width * 4, size = (stride + 1) * height;
+    uLongf length = compressBound(size);
+    int x, y;
+
+    filtered = (unsigned char*)malloc(size);
+    compressed = (unsigned char*)malloc(length);
+    for (y = 0; y < height; ++y) {
+        glook_png_filter(filtered + y * (stride + 1), pixels + y * stride, (int)stride);
+    }
+
+    x = compress2(compressed, &length, filtered, size, Z_BEST_SPEED);
+    if (x == Z_OK) {
+        glook_png_header(file, width, height);
+        glook_png_chunk(file, "IDAT", compressed, length);
+        glook_png_chunk(file, "IEND", NULL, 0);
+    }
+
+    free(filtered);
+    free(compressed);
+    return x != Z_OK || ferror(file);
 }
 
-static void glook_keyboard_callback(
-    GLFWwindow* window, int key, int scancode, int action, int mods)
+static int glook_qoi_write(
+    FILE* file, const unsigned char* pixels, const int width, const int height)
 {
-    (void)mods;
-    (void)window;
-    (void)scancode;
-    glook.keys_pressed[key] = (char)(!glook.keys[key] && !!action);
-    glook.keys[key] = (char)!!action;
+    unsigned char index[64][4] = {{0}}, prev[4] = {0, 0, 0, 255};
+    unsigned char *out, *o;
+    const int count = width * height;
+    int i, run = 0;
+
+    o = out = (unsigned char*)malloc(14 + count * 5 + 8);
+    memcpy(o, "qoif", 4);
+    o[4] = (unsigned char)(width >> 24);
+    o[5] = (unsigned char)(width >> 16);
+    o[6] = (unsigned char)(width >> 8);
+    o[7] = (unsigned char)width;
+    o[8] = (unsigned char)(height >> 24);
+    o[9] = (unsigned char)(height >> 16);
+    o[10] = (unsigned char)(height >> 8);
+    o[11] = (unsigned char)height;
+    o[12] = 4;
+    o[13] = 0;
+    o += 14;
+
+    for (i = 0; i < count; ++i) {
+        const unsigned char* px = pixels + i * 4;
+        int h;
+        if (!memcmp(px, prev, 4)) {
+            if (++run == 62 || i == count - 1) {
+                *o++ = (unsigned char)(0xC0 | (run - 1));
+                run = 0;
+            }
+            continue;
+        }
+
+        if (run) {
+            *o++ = (unsigned char)(0xC0 | (run - 1));
+            run = 0;
+        }
+
+        h = (px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64;
+        if (!memcmp(index[h], px, 4)) {
+            *o++ = (unsigned char)h;
+        } else if (px[3] == prev[3]) {
+            const int dr = (signed char)(px[0] - prev[0]);
+            const int dg = (signed char)(px[1] - prev[1]);
+            const int db = (signed char)(px[2] - prev[2]);
+            const int dgr = dr - dg, dgb = db - dg;
+            if (dr > -3 && dr < 2 && dg > -3 && dg < 2 && db > -3 && db < 2) {
+                *o++ = (unsigned char)(0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+            } else if (dgr > -9 && dgr < 8 && dg > -33 && dg < 32 && dgb > -9 && dgb < 8) {
+                *o++ = (unsigned char)(0x80 | (dg + 32));
+                *o++ = (unsigned char)((dgr + 8) << 4 | (dgb + 8));
+            } else {
+                *o++ = 0xFE;
+                *o++ = px[0];
+                *o++ = px[1];
+                *o++ = px[2];
+            }
+        } else {
+            *o++ = 0xFF;
+            memcpy(o, px, 4);
+            o += 4;
+        }
+
+        memcpy(index[h], px, 4);
+        memcpy(prev, px, 4);
+    }
+
+    memset(o, 0, 7);
+    o[7] = 1;
+    o += 8;
+    i = fwrite(out, 1, o - out, file) != (size_t)(o - out);
+    free(out);
+    return i;
 }
 
-/* file paths and droped files handling */
+/* image file decoding, every format ends up as bottom-up rgba rows */
 
-static void glook_filepaths_free(void)
+static unsigned long glook_png_u32(const unsigned char* p)
 {
-    int i;
-    for (i = 0; glook.filepaths[i] && i < GLOOK_FILE_COUNT; ++i) {
-        free(glook.filepaths[i]);
-        glook.filepaths[i] = NULL;
+    return ((unsigned long)p[0] << 24) | ((unsigned long)p[1] << 16) |
+        ((unsigned long)p[2] << 8) | (unsigned long)p[3];
+}
+
+static int glook_png_sample(const unsigned char* row, const int index, const int depth)
+{
+    if (depth == 8) {
+        return row[index];
     }
+    if (depth == 16) {
+        return row[index * 2];
+    }
+    return (row[index * depth / 8] >> (8 - depth - index * depth % 8)) & ((1 << depth) - 1);
 }
 
-static int glook_filepaths_push(const char* str)
+static void glook_png_unfilter(
+    unsigned char* raw, const size_t stride, const int height, const size_t bpp)
 {
-    if (glook.filecount == GLOOK_FILE_COUNT) {
-        glook_error_log("cannot open more than %d files\n", GLOOK_FILE_COUNT);
+    size_t x;
+    int y;
+    for (y = 0; y < height; ++y) {
+        unsigned char* row = raw + y * (stride + 1) + 1;
+        const unsigned char* up = y ? row - (stride + 1) : NULL;
+        const int filter = row[-1];
+        for (x = 0; x < stride; ++x) {
+            const int a = x >= bpp ? row[x - bpp] : 0;
+            const int b = up ? up[x] : 0;
+            const int c = up && x >= bpp ? up[x - bpp] : 0;
+            int p, pa, pb, pc;
+            switch (filter) {
+                case 1: row[x] = (unsigned char)(row[x] + a); break;
+                case 2: row[x] = (unsigned char)(row[x] + b); break;
+                case 3: row[x] = (unsigned char)(row[x] + ((a + b) >> 1)); break;
+                case 4:
+                    p = a + b - c;
+                    pa = abs(p - a);
+                    pb = abs(p - b);
+                    pc = abs(p - c);
+                    row[x] = (unsigned char)(row[x] +
+                        (pa <= pb && pa <= pc ? a : pb <= pc ? b : c));
+                    break;
+            }
+        }
+    }
+}
+
+static unsigned char* glook_png_read(
+    const unsigned char* data, const size_t size, int* width, int* height)
+{
+    static const int channels[7] = {1, 0, 3, 1, 2, 0, 4};
+    unsigned char palette[256][4];
+    unsigned char *idat = NULL, *raw, *pixels;
+    size_t idatsize = 0, pos = 8, stride;
+    unsigned long w = 0, h = 0;
+    int x, y, depth = 0, type = 0, interlace = 0, bits;
+    uLongf rawsize;
+
+    memset(palette, 0xFF, sizeof(palette));
+    while (pos + 12 <= size) {
+        const size_t length = glook_png_u32(data + pos);
+        const unsigned char *tag = data + pos + 4, *chunk = data + pos + 8;
+        if (length > size - pos - 12) {
+            break;
+        }
+
+        if (!memcmp(tag, "IHDR", 4) && length >= 13) {
+            w = glook_png_u32(chunk);
+            h = glook_png_u32(chunk + 4);
+            depth = chunk[8];
+            type = chunk[9];
+            interlace = chunk[12];
+        } else if (!memcmp(tag, "PLTE", 4)) {
+            for (x = 0; x < (int)length / 3 && x < 256; ++x) {
+                memcpy(palette[x], chunk + x * 3, 3);
+            }
+        } else if (!memcmp(tag, "tRNS", 4) && type == 3) {
+            for (x = 0; x < (int)length && x < 256; ++x) {
+                palette[x][3] = chunk[x];
+            }
+        } else if (!memcmp(tag, "IDAT", 4)) {
+            unsigned char* grown = (unsigned char*)realloc(idat, idatsize + length);
+            if (!grown) {
+                glook_error_log("out of memory reading png image data\n");
+                free(idat);
+                return NULL;
+            }
+            idat = grown;
+            memcpy(idat + idatsize, chunk, length);
+            idatsize += length;
+        } else if (!memcmp(tag, "IEND", 4)) {
+            break;
+        }
+        pos += length + 12;
+    }
+
+    if (w > GLOOK_IMAGE_MAX || h > GLOOK_IMAGE_MAX) {
+        glook_error_log("png image of %lu x %lu is too large\n", w, h);
+        free(idat);
+        return NULL;
+    }
+
+    /* sizes are capped above, so the row arithmetic below cannot wrap */
+    if (w < 1 || h < 1 || type > 6 || !channels[type] || interlace || !idat ||
+        depth > 16 || (depth & (depth - 1)) || (type != 0 && type != 3 && depth < 8) ||
+        (type == 3 && depth > 8)) {
+        glook_error_log("unsupported png: interlaced or invalid header\n");
+        free(idat);
+        return NULL;
+    }
+
+    bits = channels[type] * depth;
+    stride = ((size_t)w * bits + 7) / 8;
+    rawsize = (uLongf)((stride + 1) * h);
+    raw = (unsigned char*)malloc(rawsize);
+    pixels = (unsigned char*)malloc((size_t)w * h * 4);
+    if (!raw || !pixels) {
+        glook_error_log("could not allocate a %lu x %lu png image\n", w, h);
+        free(idat);
+        free(raw);
+        free(pixels);
+        return NULL;
+    }
+
+    if (uncompress(raw, &rawsize, idat, idatsize) != Z_OK ||
+        rawsize != (uLongf)((stride + 1) * h)) {
+        glook_error_log("corrupt png image data\n");
+        free(idat);
+        free(raw);
+        free(pixels);
+        return NULL;
+    }
+
+    free(idat);
+    glook_png_unfilter(raw, stride, (int)h, (size_t)MAX(1, bits / 8));
+    for (y = 0; y < (int)h; ++y) {
+        const unsigned char* src = raw + y * (stride + 1) + 1;
+        unsigned char* dst = pixels + (size_t)(h - 1 - y) * w * 4;
+        for (x = 0; x < (int)w; ++x, dst += 4) {
+            int k, s[4];
+            for (k = 0; k < channels[type]; ++k) {
+                s[k] = glook_png_sample(src, x * channels[type] + k, depth);
+            }
+            if (type == 3) {
+                memcpy(dst, palette[s[0]], 4);
+                continue;
+            }
+            if (type == 0 && depth < 8) {
+                s[0] = s[0] * 255 / ((1 << depth) - 1);
+            }
+            dst[0] = (unsigned char)s[0];
+            dst[1] = (unsigned char)(type == 2 || type == 6 ? s[1] : s[0]);
+            dst[2] = (unsigned char)(type == 2 || type == 6 ? s[2] : s[0]);
+            dst[3] = (unsigned char)(type == 4 ? s[1] : type == 6 ? s[3] : 255);
+        }
+    }
+
+    free(raw);
+    *width = (int)w;
+    *height = (int)h;
+    return pixels;
+}
+
+static float* glook_hdr_read(
+    const unsigned char* data, const size_t size, int* width, int* height)
+{
+    char line[64];
+    unsigned char* rgbe;
+    float* pixels;
+    size_t pos = 0;
+    int i, x, y, c, w = 0, h = 0;
+
+    /* radiance header lines end with an empty one, then '-Y <h> +X <w>' */
+    while (pos + 1 < size && !(data[pos] == '\n' && data[pos + 1] == '\n')) {
+        ++pos;
+    }
+    for (pos += 2, i = 0; pos < size && data[pos] != '\n' && i < 63; ++pos) {
+        line[i++] = (char)data[pos];
+    }
+    line[i] = 0;
+    ++pos;
+    if (sscanf(line, "-Y %d +X %d", &h, &w) != 2 || w < 1 || h < 1 ||
+        w > GLOOK_IMAGE_MAX || h > GLOOK_IMAGE_MAX) {
+        glook_error_log("unsupported hdr orientation or size '%s'\n", line);
+        return NULL;
+    }
+
+    rgbe = (unsigned char*)malloc((size_t)w * 4);
+    pixels = (float*)malloc((size_t)w * h * 4 * sizeof(float));
+    if (!rgbe || !pixels) {
+        glook_error_log("could not allocate a %d x %d hdr image\n", w, h);
+        free(rgbe);
+        free(pixels);
+        return NULL;
+    }
+    for (y = 0; y < h; ++y) {
+        float* dst = pixels + (size_t)(h - 1 - y) * w * 4;
+        if (w >= 8 && w < 32768 && pos + 4 <= size && data[pos] == 2 && data[pos + 1] == 2) {
+            /* adaptive run length scanline, each channel encoded separately */
+            pos += 4;
+            for (c = 0; c < 4; ++c) {
+                for (x = 0; x < w && pos < size;) {
+                    int count = data[pos++];
+                    if (count > 128) {
+                        count -= 128;
+                        for (i = 0; i < count && x < w && pos < size; ++i) {
+                            rgbe[(x++) * 4 + c] = data[pos];
+                        }
+                        ++pos;
+                    } else {
+                        for (i = 0; i < count && x < w && pos < size; ++i) {
+                            rgbe[(x++) * 4 + c] = data[pos++];
+                        }
+                    }
+                }
+            }
+        } else if (pos + (size_t)w * 4 <= size) {
+            memcpy(rgbe, data + pos, (size_t)w * 4);
+            pos += (size_t)w * 4;
+        } else {
+            glook_error_log("truncated hdr image data\n");
+            free(rgbe);
+            free(pixels);
+            return NULL;
+        }
+
+        for (x = 0; x < w; ++x) {
+            const unsigned char* p = rgbe + x * 4;
+            const float f = p[3] ? (float)ldexp(1.0, p[3] - 136) : 0.0F;
+            dst[x * 4 + 0] = (float)p[0] * f;
+            dst[x * 4 + 1] = (float)p[1] * f;
+            dst[x * 4 + 2] = (float)p[2] * f;
+            dst[x * 4 + 3] = 1.0F;
+        }
+    }
+
+    free(rgbe);
+    *width = w;
+    *height = h;
+    return pixels;
+}
+
+struct jpeg_error {
+    struct jpeg_error_mgr mgr;
+    jmp_buf jump;
+};
+
+static void glook_jpeg_exit(j_common_ptr info)
+{
+    char msg[JMSG_LENGTH_MAX];
+    (*info->err->format_message)(info, msg);
+    glook_error_log("jpeg: %s\n", msg);
+    longjmp(((struct jpeg_error*)info->err)->jump, 1);
+}
+
+static unsigned char* glook_jpeg_read(
+    const unsigned char* data, const size_t size, int* width, int* height)
+{
+    struct jpeg_decompress_struct info;
+    struct jpeg_error err;
+    unsigned char* volatile pixels = NULL;
+    int x, w, h;
+
+    info.err = jpeg_std_error(&err.mgr);
+    err.mgr.error_exit = glook_jpeg_exit;
+    if (setjmp(err.jump)) {
+        jpeg_destroy_decompress(&info);
+        free(pixels);
+        return NULL;
+    }
+
+    jpeg_create_decompress(&info);
+    jpeg_mem_src(&info, (unsigned char*)(size_t)data, (unsigned long)size);
+    jpeg_read_header(&info, TRUE);
+    info.out_color_space = JCS_RGB;
+    jpeg_start_decompress(&info);
+    w = (int)info.output_width;
+    h = (int)info.output_height;
+    pixels = w > GLOOK_IMAGE_MAX || h > GLOOK_IMAGE_MAX ?
+        NULL : (unsigned char*)malloc((size_t)w * h * 4);
+    if (!pixels) {
+        glook_error_log("could not allocate a %d x %d jpeg image\n", w, h);
+        jpeg_destroy_decompress(&info);
+        return NULL;
+    }
+    while (info.output_scanline < info.output_height) {
+        unsigned char* row = pixels + (size_t)(h - 1 - (int)info.output_scanline) * w * 4;
+        jpeg_read_scanlines(&info, &row, 1);
+        /* widen rgb to rgba in place, back to front so nothing is overwritten early */
+        for (x = w - 1; x >= 0; --x) {
+            const unsigned char r = row[x * 3], g = row[x * 3 + 1], b = row[x * 3 + 2];
+            row[x * 4 + 0] = r;
+            row[x * 4 + 1] = g;
+            row[x * 4 + 2] = b;
+            row[x * 4 + 3] = 0xFF;
+        }
+    }
+
+    jpeg_finish_decompress(&info);
+    jpeg_destroy_decompress(&info);
+    *width = w;
+    *height = h;
+    return pixels;
+}
+
+static unsigned char* glook_qoi_read(
+    const unsigned char* data, const size_t size, int* width, int* height)
+{
+    unsigned char index[64][4] = {{0}}, px[4] = {0, 0, 0, 255};
+    unsigned char* pixels;
+    size_t pos = 14;
+    int i, w, h, run = 0;
+    if (size < 22) {
+        return NULL;
+    }
+
+    w = (int)MIN(glook_png_u32(data + 4), GLOOK_IMAGE_MAX + 1);
+    h = (int)MIN(glook_png_u32(data + 8), GLOOK_IMAGE_MAX + 1);
+    if (w < 1 || h < 1 || w > GLOOK_IMAGE_MAX || h > GLOOK_IMAGE_MAX ||
+        (size_t)w * h > (size - 22) * 62) {
+        glook_error_log("invalid qoi header\n");
+        return NULL;
+    }
+
+    pixels = (unsigned char*)malloc((size_t)w * h * 4);
+    if (!pixels) {
+        glook_error_log("could not allocate a %d x %d qoi image\n", w, h);
+        return NULL;
+    }
+
+    for (i = 0; i < w * h; ++i) {
+        if (run) {
+            --run;
+        } else if (pos + 5 <= size) {
+            const int b = data[pos++];
+            if (b == 0xFE) {
+                memcpy(px, data + pos, 3);
+                pos += 3;
+            } else if (b == 0xFF) {
+                memcpy(px, data + pos, 4);
+                pos += 4;
+            } else if (b >> 6 == 0) {
+                memcpy(px, index[b], 4);
+            } else if (b >> 6 == 1) {
+                px[0] = (unsigned char)(px[0] + ((b >> 4) & 3) - 2);
+                px[1] = (unsigned char)(px[1] + ((b >> 2) & 3) - 2);
+                px[2] = (unsigned char)(px[2] + (b & 3) - 2);
+            } else if (b >> 6 == 2) {
+                const int dg = (b & 0x3F) - 32, n = data[pos++];
+                px[0] = (unsigned char)(px[0] + dg - 8 + (n >> 4));
+                px[1] = (unsigned char)(px[1] + dg);
+                px[2] = (unsigned char)(px[2] + dg - 8 + (n & 15));
+            } else run = b & 0x3F;
+            memcpy(index[(px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64], px, 4);
+        }
+        memcpy(pixels + ((size_t)(h - 1 - i / w) * w + i % w) * 4, px, 4);
+    }
+
+    *width = w;
+    *height = h;
+    return pixels;
+}
+
+static void* glook_image_read(
+    const unsigned char* data, const size_t size, int* width, int* height, int* hdr)
+{
+    *hdr = 0;
+    if (size >= 8 && !memcmp(data, "\211PNG", 4)) {
+        return glook_png_read(data, size, width, height);
+    }
+    if (size >= 2 && data[0] == 0xFF && data[1] == 0xD8) {
+        return glook_jpeg_read(data, size, width, height);
+    }
+    if (size >= 4 && !memcmp(data, "qoif", 4)) {
+        return glook_qoi_read(data, size, width, height);
+    }
+    if (size >= 2 && !memcmp(data, "#?", 2)) {
+        *hdr = 1;
+        return glook_hdr_read(data, size, width, height);
+    }
+    return NULL;
+}
+
+/* threaded image sequence encoder */
+
+static void* glook_encoder_worker(void* data)
+{
+    struct encoder* encoder = (struct encoder*)data;
+    char path[BUFSIZE];
+    FILE* file;
+    int len, err;
+    for (;;) {
+        struct encoder_job job;
+        pthread_mutex_lock(&encoder->lock);
+        while (!encoder->count && !encoder->done) {
+            pthread_cond_wait(&encoder->notempty, &encoder->lock);
+        }
+
+        if (!encoder->count) {
+            pthread_mutex_unlock(&encoder->lock);
+            break;
+        }
+
+        job = encoder->jobs[encoder->head];
+        encoder->head = (encoder->head + 1) % GLOOK_ENCODER_QUEUE;
+        --encoder->count;
+        pthread_cond_signal(&encoder->notfull);
+        pthread_mutex_unlock(&encoder->lock);
+
+        len = snprintf(path, sizeof(path), encoder->pattern, job.frame);
+        err = len < 0 || len >= (int)sizeof(path);
+        file = err ? NULL : fopen(path, "wb");
+        if (!file) {
+            glook_error_log("could not write image file '%s'\n", path);
+            err = 1;
+        } else {
+            err = encoder->format == GLOOK_EXPORT_QOI ?
+                glook_qoi_write(file, job.pixels, encoder->width, encoder->height) :
+                glook_png_write(file, job.pixels, encoder->width, encoder->height);
+            if (fclose(file) || err) {
+                glook_error_log("failed to encode image file '%s'\n", path);
+                err = 1;
+            }
+        }
+
+        /* any lost frame fails the whole export once the workers are joined */
+        free(job.pixels);
+        if (err) {
+            pthread_mutex_lock(&encoder->lock);
+            encoder->failed = 1;
+            pthread_mutex_unlock(&encoder->lock);
+        }
+    }
+    return NULL;
+}
+
+static void glook_encoder_push(struct encoder* encoder, unsigned char* pixels, int frame)
+{
+    /* the queue is bounded, the render loop only waits when every slot is busy */
+    pthread_mutex_lock(&encoder->lock);
+    while (encoder->count == GLOOK_ENCODER_QUEUE) {
+        pthread_cond_wait(&encoder->notfull, &encoder->lock);
+    }
+
+    encoder->jobs[(encoder->head + encoder->count) % GLOOK_ENCODER_QUEUE].frame = frame;
+    encoder->jobs[(encoder->head + encoder->count) % GLOOK_ENCODER_QUEUE].pixels = pixels;
+    ++encoder->count;
+    pthread_cond_signal(&encoder->notempty);
+    pthread_mutex_unlock(&encoder->lock);
+}
+
+static int glook_encoder_pattern(const char* pattern)
+{
+    int width = 0;
+    const char* c = strchr(pattern, '%');
+    if (!c) {
+        return EXIT_FAILURE;
+    }
+
+    /* at most a two digit width, so a formatted name stays within BUFSIZE */
+    for (++c; *c >= '0' && *c <= '9'; ++c) {
+        ++width;
+    }
+    if (width > 2 || *c != 'd' || strchr(c, '%') || strlen(pattern) + 100 >= BUFSIZE) {
         return EXIT_FAILURE;
     }
-    glook.filepaths[glook.filecount++] = glook_strdup(str);
     return EXIT_SUCCESS;
 }
 
-static void glook_file_drop(struct pipeline* pipeline)
+static int glook_encoder_free(struct encoder* encoder)
+{
+    int i, failed;
+    pthread_mutex_lock(&encoder->lock);
+    encoder->done = 1;
+    pthread_cond_broadcast(&encoder->notempty);
+    pthread_mutex_unlock(&encoder->lock);
+    for (i = 0; i < encoder->threadcount; ++i) {
+        pthread_join(encoder->threads[i], NULL);
+    }
+
+    for (i = 0; i < encoder->count; ++i) {
+        free(encoder->jobs[(encoder->head + i) % GLOOK_ENCODER_QUEUE].pixels);
+    }
+
+    pthread_cond_destroy(&encoder->notfull);
+    pthread_cond_destroy(&encoder->notempty);
+    pthread_mutex_destroy(&encoder->lock);
+    failed = encoder->failed;
+    free(encoder->pattern);
+    free(encoder);
+    return failed;
+}
+
+static struct encoder* glook_encoder_create(
+    const char* pattern, unsigned int format, const int width, const int height)
 {
     int i;
-    for (i = 0; i < glook.filecount; ++i) {
-        if (glook_pipeline_push(pipeline, glook.filepaths[i]) == EXIT_FAILURE) {
-            free(pipeline->shaders[pipeline->count - 1].fpath);
-            pipeline->shaders[pipeline->count - 1].fpath = glook.filepaths[i];
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    struct encoder* encoder;
+    if (glook_encoder_pattern(pattern)) {
+        glook_error_log(
+            "invalid image sequence pattern '%s' (expected one %%d field)\n", pattern
+        );
+        return NULL;
+    }
+
+    encoder = (struct encoder*)calloc(1, sizeof(struct encoder));
+    encoder->pattern = glook_strdup(pattern);
+    encoder->format = format;
+    encoder->width = width;
+    encoder->height = height;
+    pthread_mutex_init(&encoder->lock, NULL);
+    pthread_cond_init(&encoder->notempty, NULL);
+    pthread_cond_init(&encoder->notfull, NULL);
+
+    cores = cores < 1 ? 1 : cores > GLOOK_ENCODER_THREADS ? GLOOK_ENCODER_THREADS : cores;
+    for (i = 0; i < cores; ++i) {
+        if (pthread_create(encoder->threads + i, NULL, glook_encoder_worker, encoder)) {
+            break;
         }
-        glook.filepaths[i] = NULL;
+        ++encoder->threadcount;
     }
-    glook.filecount = 0;
+
+    if (!encoder->threadcount) {
+        glook_error_log("could not start image encoder threads\n");
+        glook_encoder_free(encoder);
+        return NULL;
+    }
+    return encoder;
 }
 
-static void glook_file_drop_callback(GLFWwindow* window, int count, const char** paths)
+/* golden image regression, frames are hashed and compared against reference pngs */
+
+static void glook_golden_push(struct golden* golden, const struct golden_entry* entry)
+{
+    if (golden->count == golden->capacity) {
+        golden->capacity = golden->capacity ? golden->capacity * 2 : 64;
+        golden->entries = (struct golden_entry*)realloc(
+            golden->entries, golden->capacity * sizeof(struct golden_entry)
+        );
+    }
+    golden->entries[golden->count++] = *entry;
+}
+
+static int glook_golden_create(struct golden* golden, const char* dir)
+{
+    char path[BUFSIZE + 32], line[128];
+    struct golden_entry entry;
+    FILE* file;
+    memset(golden, 0, sizeof(struct golden));
+    if (strlen(dir) > BUFSIZE || glook_mkdir(dir)) {
+        glook_error_log("could not create golden directory '%s'\n", dir);
+        return EXIT_FAILURE;
+    }
+
+    golden->dir = dir;
+    golden->tolerance = (int)glook.opts.tolerance;
+    sprintf(path, "%s/golden.txt", dir);
+    file = fopen(path, "r");
+    if (!file) {
+        return EXIT_SUCCESS;
+    }
+
+    /* '<frame> <width> <height> <hash>' per line */
+    while (fgets(line, sizeof(line), file)) {
+        if (sscanf(line, "%d %d %d %8lx%8lx", &entry.frame, &entry.width, &entry.height,
+            entry.hash, entry.hash + 1) == 5) {
+            glook_golden_push(golden, &entry);
+        }
+    }
+    fclose(file);
+    return EXIT_SUCCESS;
+}
+
+static struct golden_entry* glook_golden_entry(struct golden* golden, const int frame)
 {
     int i;
-    (void)window;
-    for (i = 0; i < count; i++) {
-        if (glook_filepaths_push(paths[i])) {
-            break;
+    for (i = 0; i < golden->count; ++i) {
+        if (golden->entries[i].frame == frame) {
+            return golden->entries + i;
+        }
+    }
+    return NULL;
+}
+
+static int glook_golden_compare(struct golden* golden, const unsigned char* rgba,
+    const int width, const int height, const int frame, const char* path)
+{
+    char diffpath[BUFSIZE + 32];
+    const unsigned char *ref, *a, *b;
+    unsigned char *reference, *data, *diff;
+    size_t size;
+    int x, y, k, w, h, d, max = 0, count = 0;
+    FILE* file;
+    if (access(path, F_OK)) {
+        glook_error_log("frame %d changed and has no reference image '%s'\n", frame, path);
+        return EXIT_FAILURE;
+    }
+
+    data = glook_file_stat(path, &size) ? NULL : (unsigned char*)glook_file_read(path, 0);
+    if (!data) {
+        return EXIT_FAILURE;
+    }
+
+    reference = glook_png_read(data, size, &w, &h);
+    free(data);
+    if (!reference) {
+        glook_error_log("could not decode reference image '%s'\n", path);
+        return EXIT_FAILURE;
+    }
+
+    if (w != width || h != height) {
+        glook_error_log("frame %d is %d x %d but reference '%s' is %d x %d\n",
+            frame, width, height, path, w, h
+        );
+        free(reference);
+        return EXIT_FAILURE;
+    }
+
+    /* decoded images are bottom-up, readback rows top-down */
+    diff = (unsigned char*)malloc((size_t)width * height * 4);
+    for (y = 0; y < height; ++y) {
+        ref = reference + (size_t)(height - 1 - y) * width * 4;
+        for (x = 0; x < width; ++x) {
+            unsigned char* out = diff + ((size_t)y * width + x) * 4;
+            a = rgba + ((size_t)y * width + x) * 4;
+            b = ref + x * 4;
+            for (k = d = 0; k < 4; ++k) {
+                d = MAX(d, abs(a[k] - b[k]));
+            }
+
+            /* mismatches in red over a dimmed copy of the reference */
+            max = MAX(max, d);
+            if (d > golden->tolerance) {
+                ++count;
+                out[0] = (unsigned char)(128 + d / 2);
+                out[1] = out[2] = 0;
+            } else out[0] = out[1] = out[2] = (unsigned char)((b[0] + b[1] + b[2]) / 12);
+            out[3] = 0xFF;
         }
     }
+
+    /* a diff left over from an earlier failing run is stale once the frame matches */
+    free(reference);
+    sprintf(diffpath, "%s/frame%04d.diff.png", golden->dir, frame);
+    if (!count) {
+        remove(diffpath);
+    } else {
+        file = fopen(diffpath, "wb");
+        if (file) {
+            int err = glook_png_write(file, diff, width, height);
+            if (fclose(file) || err) {
+                remove(diffpath);
+            }
+        }
+        glook_error_log("frame %d differs in %d pixels by up to %d, see '%s'\n",
+            frame, count, max, diffpath
+        );
+    }
+    free(diff);
+    return count ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+static void glook_golden_frame(struct golden* golden,
+    const unsigned char* rgba, const int width, const int height, const int frame)
+{
+    char path[BUFSIZE + 32];
+    struct golden_entry record, *entry = glook_golden_entry(golden, frame);
+    FILE* file;
+    int err;
+    glook_hash_init(record.hash);
+    glook_hash_update(record.hash, rgba, (size_t)width * height * 4);
+    if (entry && entry->width == width && entry->height == height &&
+        glook_hash_equal(entry->hash, record.hash)) {
+        ++golden->identical;
+        return;
+    }
+
+    /* a changed hash falls back to a per channel comparison with the reference */
+    sprintf(path, "%s/frame%04d.png", golden->dir, frame);
+    if (entry || !access(path, F_OK)) {
+        if (glook_golden_compare(golden, rgba, width, height, frame, path)) {
+            ++golden->failed;
+        } else ++golden->matched;
+        return;
+    }
+
+    /* frames without a reference record one */
+    file = fopen(path, "wb");
+    err = !file || glook_png_write(file, rgba, width, height);
+    if ((file && fclose(file)) || err) {
+        glook_error_log("could not write reference image '%s'\n", path);
+        ++golden->failed;
+        return;
+    }
+
+    record.frame = frame;
+    record.width = width;
+    record.height = height;
+    glook_golden_push(golden, &record);
+    ++golden->recorded;
+}
+
+static int glook_golden_finish(struct golden* golden)
+{
+    int i, err = golden->failed > 0;
+    char path[BUFSIZE + 32];
+    FILE* file;
+    if (golden->recorded) {
+        sprintf(path, "%s/golden.txt", golden->dir);
+        file = fopen(path, "w");
+        for (i = 0; file && i < golden->count; ++i) {
+            const struct golden_entry* entry = golden->entries + i;
+            fprintf(file, "%d %d %d %08lx%08lx\n", entry->frame,
+                entry->width, entry->height, entry->hash[0], entry->hash[1]
+            );
+        }
+        if (!file || fclose(file)) {
+            glook_error_log("could not write golden manifest '%s'\n", path);
+            err = 1;
+        }
+    }
+
+    glook_log("golden: %d identical, %d within tolerance, %d recorded, %d failed\n",
+        golden->identical, golden->matched, golden->recorded, golden->failed
+    );
+    free(golden->entries);
+    memset(golden, 0, sizeof(struct golden));
+    return err ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/* asynchronous framebuffer readback and frame streaming */
+
+static void glook_y4m_convert(
+    unsigned char* yuv, const unsigned char* rgba, const int width, const int height)
+{
+    int x, y, i, j;
+    const int cw = (width + 1) / 2, ch = (height + 1) / 2;
+    unsigned char *u = yuv + width * height, *v = u + cw * ch;
+
+    /* BT.601 studio range, rows are flipped from OpenGL's bottom-up order */
+    for (y = 0; y < height; ++y) {
+        const unsigned char* row = rgba + (height - 1 - y) * width * 4;
+        for (x = 0; x < width; ++x) {
+            const int r = row[x * 4], g = row[x * 4 + 1], b = row[x * 4 + 2];
+            yuv[y * width + x] = (unsigned char)((66 * r + 129 * g + 25 * b + 4224) >> 8);
+        }
+    }
+
+    for (y = 0; y < ch; ++y) {
+        for (x = 0; x < cw; ++x) {
+            int r = 0, g = 0, b = 0, n = 0;
+            for (j = y * 2; j < MIN(y * 2 + 2, height); ++j) {
+                const unsigned char* row = rgba + (height - 1 - j) * width * 4;
+                for (i = x * 2; i < MIN(x * 2 + 2, width); ++i) {
+                    r += row[i * 4];
+                    g += row[i * 4 + 1];
+                    b += row[i * 4 + 2];
+                    ++n;
+                }
+            }
+            r /= n;
+            g /= n;
+            b /= n;
+            u[y * cw + x] = (unsigned char)((-38 * r - 74 * g + 112 * b + 32896) >> 8);
+            v[y * cw + x] = (unsigned char)((112 * r - 94 * g - 18 * b + 32896) >> 8);
+        }
+    }
+}
+
+static int glook_readback_write(struct readback* readback, const unsigned char* rgba)
+{
+    int y;
+    const size_t stride = readback->width * 4;
+    if (readback->format == GLOOK_EXPORT_Y4M) {
+        const int w = readback->width, h = readback->height;
+        const size_t size = w * h + ((w + 1) / 2) * ((h + 1) / 2) * 2;
+        glook_y4m_convert(readback->yuv, rgba, w, h);
+        if (fputs("FRAME\n", readback->file) == EOF ||
+            fwrite(readback->yuv, 1, size, readback->file) != size) {
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    for (y = readback->height - 1; y >= 0; --y) {
+        if (fwrite(rgba + y * stride, 1, stride, readback->file) != stride) {
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+static size_t glook_readback_pixel_size(const unsigned int layout, const unsigned int type)
+{
+    return (layout == GL_RED ? 1 : 4) * (type == GL_FLOAT ? sizeof(float) : 1);
+}
+
+static void glook_readback_drop(struct readback* readback, const int frame, const char* why)
+{
+    /* a dropped frame fails the export, and counts as a failed golden comparison */
+    glook_error_log("%s frame %d, it is missing from the export\n", why, frame);
+    readback->failed = 1;
+    if (readback->format == GLOOK_EXPORT_GOLDEN) {
+        ++glook.golden.failed;
+    }
+}
+
+static void glook_readback_pop(struct readback* readback, const int wait)
+{
+    const int i = (readback->head - readback->count + GLOOK_READBACK_COUNT) %
+        GLOOK_READBACK_COUNT;
+    const int w = readback->width, h = readback->height;
+    const unsigned int layout = readback->layouts[i], type = readback->types[i];
+    const size_t size = w * h * glook_readback_pixel_size(layout, type);
+    GLenum status;
+    void* pixels;
+
+    status = glClientWaitSync(
+        readback->fences[i], GL_SYNC_FLUSH_COMMANDS_BIT, wait ? 1000000000 : 0
+    );
+    if (status == GL_TIMEOUT_EXPIRED && !wait) {
+        return;
+    }
+
+    glDeleteSync(readback->fences[i]);
+    readback->fences[i] = NULL;
+    --readback->count;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->pbos[i]);
+    pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+    if (!pixels) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        glook_readback_drop(readback, readback->frames[i], "could not map");
+        return;
+    }
+
+    if (readback->format == GLOOK_EXPORT_GOLDEN || readback->encoder) {
+        unsigned char* rgba = (unsigned char*)malloc(w * h * 4);
+        if (!rgba) {
+            glook_readback_drop(readback, readback->frames[i], "out of memory for");
+        } else if (readback->encoder) {
+            glook_convert_pixels(rgba, pixels, w, h, layout, type);
+            glook_encoder_push(readback->encoder, rgba, readback->frames[i]);
+        } else {
+            glook_convert_pixels(rgba, pixels, w, h, layout, type);
+            glook_golden_frame(&glook.golden, rgba, w, h, readback->frames[i]);
+            free(rgba);
+        }
+    } else if (readback->file) {
+        if (layout == GL_RED) {
+            if (!readback->grey) {
+                readback->grey = (unsigned char*)malloc(w * h * 4);
+            }
+            if (readback->grey) {
+                glook_convert_grey8(readback->grey, pixels, w, h, type, 0);
+            }
+            pixels = readback->grey;
+        }
+
+        if (!pixels) {
+            glook_readback_drop(readback, readback->frames[i], "out of memory for");
+        } else if (glook_readback_write(readback, pixels)) {
+            glook_error_log("could not write frame, stopping export\n");
+            if (readback->file != stdout) {
+                fclose(readback->file);
+            }
+            readback->file = NULL;
+            readback->failed = 1;
+        }
+    }
+
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+static void glook_readback_push(
+    struct readback* readback, const struct framebuffer* fb, const int frame)
+{
+    /* read only the channels and precision the target actually stores */
+    const struct format* format = glook_format_get(fb->texture.format);
+    const unsigned int layout = format->layout;
+    const unsigned int type = readback->convert && format->type != GL_UNSIGNED_BYTE ?
+        GL_FLOAT : GL_UNSIGNED_BYTE;
+
+    /* only wait on the oldest frame in flight when every buffer is taken */
+    while (readback->count && readback->count == GLOOK_READBACK_COUNT) {
+        glook_readback_pop(readback, 1);
+    }
+
+    /* scaled heads are stretched to the output size like the present pass does */
+    if (fb->texture.width != readback->width || fb->texture.height != readback->height) {
+        glook_framebuffer_realloc(&readback->resolve,
+            readback->width, readback->height, fb->texture.format
+        );
+        if (!readback->resolve.fbo) {
+            readback->resolve = glook_pool_acquire(
+                &glook.pool, readback->width, readback->height, fb->texture.format
+            );
+        }
+        glook_state_framebuffer(GL_READ_FRAMEBUFFER, fb->fbo);
+        glook_state_framebuffer(GL_DRAW_FRAMEBUFFER, readback->resolve.fbo);
+        glBlitFramebuffer(0, 0, fb->texture.width, fb->texture.height,
+            0, 0, readback->width, readback->height, GL_COLOR_BUFFER_BIT, GL_LINEAR
+        );
+        fb = &readback->resolve;
+    }
+
+    glook_state_framebuffer(GL_READ_FRAMEBUFFER, fb->fbo);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->pbos[readback->head]);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, readback->width, readback->height, layout, type, NULL);
+    readback->frames[readback->head] = frame;
+    readback->layouts[readback->head] = layout;
+    readback->types[readback->head] = type;
+    readback->fences[readback->head] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    readback->head = (readback->head + 1) % GLOOK_READBACK_COUNT;
+    ++readback->count;
+
+    /* drain anything that already landed without blocking */
+    while (readback->count > 1) {
+        const int count = readback->count;
+        glook_readback_pop(readback, 0);
+        if (count == readback->count) {
+            break;
+        }
+    }
+}
+
+static int glook_readback_create(struct readback* readback, 
+    const char* path, unsigned int format, const int width, const int height)
+{
+    int i;
+    size_t size;
+    memset(readback, 0, sizeof(struct readback));
+    if (format == GLOOK_EXPORT_GOLDEN) {
+        if (glook_golden_create(&glook.golden, path)) {
+            return EXIT_FAILURE;
+        }
+    } else if (format == GLOOK_EXPORT_PNG || format == GLOOK_EXPORT_QOI) {
+        readback->encoder = glook_encoder_create(path, format, width, height);
+        if (!readback->encoder) {
+            return EXIT_FAILURE;
+        }
+    } else if (path[0] == '-' && !path[1]) {
+        readback->file = stdout;
+    } else readback->file = fopen(path, "wb");
+
+    if (!readback->file && !readback->encoder && format != GLOOK_EXPORT_GOLDEN) {
+        glook_error_log("could not open output file '%s'\n", path);
+        return EXIT_FAILURE;
+    }
+
+    /* frames converted to rgba8 on the cpu keep float targets at full precision */
+    readback->convert = readback->encoder || format == GLOOK_EXPORT_GOLDEN;
+    size = width * height * glook_readback_pixel_size(
+        GL_RGBA, readback->convert ? GL_FLOAT : GL_UNSIGNED_BYTE
+    );
+    readback->format = format;
+    readback->width = width;
+    readback->height = height;
+    if (format == GLOOK_EXPORT_Y4M) {
+        readback->yuv = (unsigned char*)malloc(
+            width * height + ((width + 1) / 2) * ((height + 1) / 2) * 2
+        );
+        if (!readback->yuv) {
+            glook_error_log("could not allocate a %d x %d frame for '%s'\n", width, height, path);
+            return EXIT_FAILURE;
+        }
+        fprintf(readback->file, "YUV4MPEG2 W%d H%d F%u:1 Ip A1:1 C420jpeg\n",
+            width, height, glook.opts.fps
+        );
+    }
+
+    glGenBuffers(GLOOK_READBACK_COUNT, readback->pbos);
+    for (i = 0; i < GLOOK_READBACK_COUNT; ++i) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->pbos[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return EXIT_SUCCESS;
+}
+
+static unsigned int glook_readback_format(const char* path, const unsigned int raw)
+{
+    const char* ext = strrchr(path, '.');
+    if (!strchr(path, '%')) {
+        return raw ? GLOOK_EXPORT_RAW : GLOOK_EXPORT_Y4M;
+    }
+    return ext && !strcmp(ext, ".qoi") ? GLOOK_EXPORT_QOI : GLOOK_EXPORT_PNG;
+}
+
+static int glook_readback_free(struct readback* readback)
+{
+    int failed;
+    while (readback->count) {
+        glook_readback_pop(readback, 1);
+    }
+
+    if (readback->file && (readback->file != stdout ?
+        fclose(readback->file) : fflush(readback->file))) {
+        glook_error_log("could not finish writing the exported frames\n");
+        readback->failed = 1;
+    }
+
+    if (readback->encoder && glook_encoder_free(readback->encoder)) {
+        readback->failed = 1;
+    }
+
+    if (readback->pbos[0]) {
+        glDeleteBuffers(GLOOK_READBACK_COUNT, readback->pbos);
+    }
+
+    glook_framebuffer_free(&readback->resolve);
+    free(readback->yuv);
+    free(readback->grey);
+    failed = readback->failed;
+    memset(readback, 0, sizeof(struct readback));
+    return failed;
+}
+
+/* persistent program binary cache */
+
+static void glook_cache_init(void)
+{
+    int formats = 0;
+    const char *xdg = getenv("XDG_CACHE_HOME"), *home = getenv("HOME");
+    glook.cachedir[0] = 0;
+    if (glook.opts.nocache) {
+        return;
+    }
+
+    /* decoded images are cached regardless, program binaries only where supported */
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    glook.binaries = formats > 0;
+    if (xdg && xdg[0] && strlen(xdg) + 16 < BUFSIZE) {
+        sprintf(glook.cachedir, "%s/glook", xdg);
+    } else if (home && home[0] && strlen(home) + 16 < BUFSIZE) {
+        sprintf(glook.cachedir, "%s/.cache", home);
+        glook_mkdir(glook.cachedir);
+        strcat(glook.cachedir, "/glook");
+    }
+
+    if (glook.cachedir[0] && glook_mkdir(glook.cachedir)) {
+        glook.cachedir[0] = 0;
+    }
+}
+
+static void glook_cache_path(char* path, const char* source)
+{
+    unsigned long hash[2];
+    const char* strings[4];
+    int i;
+
+    /* binaries are only valid for the exact sources and driver that built them */
+    strings[0] = source;
+    strings[1] = glook_shader_string_triangle;
+    strings[2] = (const char*)glGetString(GL_RENDERER);
+    strings[3] = (const char*)glGetString(GL_VERSION);
+    glook_hash_init(hash);
+    for (i = 0; i < 4; ++i) {
+        if (strings[i]) {
+            glook_hash_update(hash, strings[i], strlen(strings[i]) + 1);
+        }
+    }
+    sprintf(path, "%s/%08lx%08lx.bin", glook.cachedir, hash[0], hash[1]);
+}
+
+static int glook_cache_load(const unsigned int program, const char* path)
+{
+    int success = 0;
+    unsigned int header[3];
+    struct stat st;
+    void* binary;
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return EXIT_FAILURE;
+    }
+
+    /* the stored length must account for the whole file, anything else is corrupt */
+    if (fread(header, sizeof(header), 1, file) != 1 || header[0] != GLOOK_CACHE_MAGIC ||
+        fstat(fileno(file), &st) || header[2] > GLOOK_CACHE_MAX ||
+        (size_t)st.st_size != sizeof(header) + header[2]) {
+        fclose(file);
+        return EXIT_FAILURE;
+    }
+
+    binary = malloc(header[2]);
+    if (binary && fread(binary, 1, header[2], file) == header[2]) {
+        glProgramBinary(program, header[1], binary, header[2]);
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+    }
+
+    free(binary);
+    fclose(file);
+    return !success;
+}
+
+static void glook_cache_store(const unsigned int program, const char* path)
+{
+    char tmp[BUFSIZE + 64];
+    unsigned int header[3];
+    int length = 0;
+    GLenum format;
+    void* binary;
+    FILE* file;
+
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length < 1) {
+        return;
+    }
+
+    binary = malloc(length);
+    glGetProgramBinary(program, length, &length, &format, binary);
+    header[0] = GLOOK_CACHE_MAGIC;
+    header[1] = format;
+    header[2] = length;
+
+    /* write aside and rename so concurrent instances never read partial files */
+    sprintf(tmp, "%s.%ld", path, (long)getpid());
+    file = fopen(tmp, "wb");
+    if (file) {
+        int err = fwrite(header, sizeof(header), 1, file) != 1 ||
+            fwrite(binary, 1, length, file) != (size_t)length;
+        if (fclose(file) || err || rename(tmp, path)) {
+            remove(tmp);
+        }
+    }
+    free(binary);
+}
+
+/* streamed video inputs, a decoder thread runs ahead of playback into a frame ring */
+
+static unsigned char glook_clamp8(const int n)
+{
+    return (unsigned char)(n < 0 ? 0 : n > 255 ? 255 : n);
+}
+
+static int glook_stream_y4m_open(struct stream* stream)
+{
+    char line[BUFSIZE];
+    const char *tok, *chroma = "420";
+    int num = 0, den = 0, valid = 1;
+    long size;
+
+    stream->file = fopen(stream->path, "rb");
+    if (!stream->file) {
+        glook_error_log("could not open video: '%s'\n", stream->path);
+        return EXIT_FAILURE;
+    }
+
+    if (!fgets(line, sizeof(line), stream->file) || strncmp(line, "YUV4MPEG2 ", 10)) {
+        glook_error_log("not a yuv4mpeg2 video: '%s'\n", stream->path);
+        return EXIT_FAILURE;
+    }
+
+    for (tok = line + 9; tok; tok = strchr(tok + 1, ' ')) {
+        switch (tok[1]) {
+            case 'W': stream->width = atoi(tok + 2); break;
+            case 'H': stream->height = atoi(tok + 2); break;
+            case 'F': sscanf(tok + 2, "%d:%d", &num, &den); break;
+            case 'C': chroma = tok + 2; break;
+        }
+    }
+
+    /* subsampled planes are addressed by scaling, covering 420, 422, 444 and mono */
+    stream->chroma[0] = (stream->width + 1) / 2;
+    stream->chroma[1] = (stream->height + 1) / 2;
+    if (!strncmp(chroma, "444", 3)) {
+        stream->chroma[0] = stream->width;
+        stream->chroma[1] = stream->height;
+    } else if (!strncmp(chroma, "422", 3)) {
+        stream->chroma[1] = stream->height;
+    } else if (!strncmp(chroma, "mono", 4)) {
+        stream->chroma[0] = stream->chroma[1] = 0;
+        valid = !isdigit((unsigned char)chroma[4]);
+    } else valid = !strncmp(chroma, "420", 3);
+
+    /* only 8-bit samples, 'p10' style depths and alpha planes are rejected */
+    if (stream->width < 1 || stream->height < 1 || !valid ||
+        chroma[3] == 'p' || chroma[3] == 'a') {
+        glook_error_log("unsupported yuv4mpeg2 size or colorspace: '%s'\n", stream->path);
+        return EXIT_FAILURE;
+    }
+
+    /* every frame has the same header, so frames are found by offset alone */
+    stream->offset = ftell(stream->file);
+    if (!fgets(line, sizeof(line), stream->file) || strncmp(line, "FRAME", 5)) {
+        glook_error_log("video has no frames: '%s'\n", stream->path);
+        return EXIT_FAILURE;
+    }
+
+    stream->framesize = (long)strlen(line) + (long)stream->width * stream->height +
+        (long)stream->chroma[0] * stream->chroma[1] * 2;
+    fseek(stream->file, 0, SEEK_END);
+    size = ftell(stream->file);
+    stream->count = (int)((size - stream->offset) / stream->framesize);
+    stream->fps = num > 0 && den > 0 ? (double)num / (double)den : stream->fps;
+    stream->planes = (unsigned char*)malloc(stream->framesize);
+    return stream->count ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int glook_stream_y4m_read(
+    struct stream* stream, const int index, unsigned char* rgba)
+{
+    int x, y;
+    const int w = stream->width, h = stream->height;
+    const int cw = stream->chroma[0], ch = stream->chroma[1];
+    const long size = (long)w * h + (long)cw * ch * 2;
+    const unsigned char* u = stream->planes + (size_t)w * h;
+    const unsigned char* v = u + (size_t)cw * ch;
+
+    if (fseek(stream->file, stream->offset + (long)(index + 1) * stream->framesize - size,
+        SEEK_SET) || fread(stream->planes, 1, size, stream->file) != (size_t)size) {
+        return EXIT_FAILURE;
+    }
+
+    /* BT.601 studio range back to rgb, the inverse of glook_y4m_convert */
+    for (y = 0; y < h; ++y) {
+        const unsigned char* luma = stream->planes + (size_t)y * w;
+        unsigned char* dst = rgba + (size_t)(h - 1 - y) * w * 4;
+        for (x = 0; x < w; ++x, dst += 4) {
+            const int c = 298 * (luma[x] - 16);
+            int d = 0, e = 0;
+            if (cw) {
+                const size_t k = (size_t)(y * ch / h) * cw + x * cw / w;
+                d = u[k] - 128;
+                e = v[k] - 128;
+            }
+            dst[0] = glook_clamp8((c + 409 * e + 128) >> 8);
+            dst[1] = glook_clamp8((c - 100 * d - 208 * e + 128) >> 8);
+            dst[2] = glook_clamp8((c + 516 * d + 128) >> 8);
+            dst[3] = 0xFF;
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+static int glook_stream_path(char* path, const struct stream* stream, const int index)
+{
+    /* patterns are validated when the stream is opened, this only guards the buffer */
+    const int len = snprintf(path, BUFSIZE, stream->path, index);
+    return len < 0 || len >= BUFSIZE;
+}
+
+static unsigned char* glook_stream_image_decode(
+    const struct stream* stream, const int index, int* width, int* height)
+{
+    char path[BUFSIZE];
+    size_t size;
+    unsigned char *data, *pixels;
+    int hdr;
+
+    if (glook_stream_path(path, stream, stream->first + index) ||
+        glook_file_stat(path, &size)) {
+        return NULL;
+    }
+
+    data = (unsigned char*)glook_file_read(path, 0);
+    if (!data) {
+        return NULL;
+    }
+
+    pixels = (unsigned char*)glook_image_read(data, size, width, height, &hdr);
+    free(data);
+    if (pixels && hdr) {
+        glook_error_log("hdr images cannot be streamed: '%s'\n", path);
+        free(pixels);
+        return NULL;
+    }
+    return pixels;
+}
+
+static int glook_stream_sequence_open(struct stream* stream)
+{
+    char path[BUFSIZE];
+    struct stat st;
+    unsigned char* pixels;
+
+    /* numbered from either 0 or 1, the sequence ends at the first missing file */
+    stream->first = glook_stream_path(path, stream, 0) || stat(path, &st) ? 1 : 0;
+    for (;; ++stream->count) {
+        if (glook_stream_path(path, stream, stream->first + stream->count) ||
+            stat(path, &st)) {
+            break;
+        }
+    }
+
+    if (!stream->count) {
+        glook_error_log("no images found for sequence '%s'\n", stream->path);
+        return EXIT_FAILURE;
+    }
+
+    pixels = glook_stream_image_decode(stream, 0, &stream->width, &stream->height);
+    free(pixels);
+    return pixels ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int glook_stream_sequence_read(
+    struct stream* stream, const int index, unsigned char* rgba)
+{
+    int w = 0, h = 0;
+    unsigned char* pixels = glook_stream_image_decode(stream, index, &w, &h);
+    if (pixels && w == stream->width && h == stream->height) {
+        memcpy(rgba, pixels, (size_t)w * h * 4);
+    }
+
+    free(pixels);
+    return pixels && w == stream->width && h == stream->height ? 
+        EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static void* glook_stream_worker(void* data)
+{
+    struct stream* stream = (struct stream*)data;
+    int warned = 0, epoch = 0, cursor = 0, head = 0;
+    size_t framesize;
+
+    if (stream->sequence ? glook_stream_sequence_open(stream) : glook_stream_y4m_open(stream)) {
+        GLOOK_ATOMIC_STORE(&stream->ready, -1);
+        return NULL;
+    }
+
+    /* memory is bounded by the ring, however long the stream is */
+    framesize = (size_t)stream->width * stream->height * 4;
+    stream->slots = (unsigned char*)malloc(framesize * GLOOK_STREAM_RING);
+    GLOOK_ATOMIC_STORE(&stream->ready, 1);
+
+    while (!GLOOK_ATOMIC_LOAD(&stream->done)) {
+        unsigned char* slot;
+        const int e = GLOOK_ATOMIC_LOAD(&stream->epoch);
+        if (e != epoch) {
+            /* playback jumped, frames decoded from here on carry the new epoch */
+            epoch = e;
+            cursor = GLOOK_ATOMIC_LOAD(&stream->seek);
+            GLOOK_ATOMIC_STORE(&stream->cursor, cursor);
+            GLOOK_ATOMIC_STORE(&stream->ack, epoch);
+        }
+
+        if (head - GLOOK_ATOMIC_LOAD(&stream->tail) >= GLOOK_STREAM_RING) {
+            glook_sleep(0.001);
+            continue;
+        }
+
+        slot = stream->slots + (size_t)(head % GLOOK_STREAM_RING) * framesize;
+        if (stream->sequence ? glook_stream_sequence_read(stream, cursor, slot) :
+            glook_stream_y4m_read(stream, cursor, slot)) {
+            if (!warned++) {
+                glook_error_log("could not decode frame %d of '%s'\n", cursor, stream->path);
+            }
+            memset(slot, 0, framesize);
+        }
+
+        stream->frames[head % GLOOK_STREAM_RING] = cursor;
+        stream->epochs[head % GLOOK_STREAM_RING] = epoch;
+        GLOOK_ATOMIC_STORE(&stream->head, ++head);
+        cursor = (cursor + 1) % stream->count;
+        GLOOK_ATOMIC_STORE(&stream->cursor, cursor);
+    }
+    return NULL;
+}
+
+static int glook_stream_upload(struct stream* stream, const unsigned char* frame)
+{
+    int i, resized = 0;
+    const int w = stream->width, h = stream->height;
+    const size_t size = (size_t)w * h * 4;
+    const double t = glook_clock();
+    void* dst;
+
+    if (!stream->pbos[0]) {
+        glGenBuffers(GLOOK_STREAM_PBOS, stream->pbos);
+        for (i = 0; i < GLOOK_STREAM_PBOS; ++i) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, stream->pbos[i]);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glook_state_texture(glook.state.unit, stream->texture.id);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        stream->texture.width = w;
+        stream->texture.height = h;
+        resized = 1;
+    }
+
+    /* alternate buffers so the copy never waits on the previous frame's transfer */
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, stream->pbos[stream->pbo]);
+    stream->pbo = (stream->pbo + 1) % GLOOK_STREAM_PBOS;
+    dst = glMapBufferRange(
+        GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT
+    );
+    if (dst) {
+        memcpy(dst, frame, size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    } else glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    glook_state_texture(glook.state.unit, stream->texture.id);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE,
+        dst ? NULL : frame
+    );
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glook_trace_span("stream", stream->path, t);
+    return resized;
+}
+
+static void glook_stream_seek(struct stream* stream, const int frame)
+{
+    /* everything queued so far is dropped, the worker restarts at the frame */
+    GLOOK_ATOMIC_STORE(&stream->seek, frame);
+    GLOOK_ATOMIC_STORE(&stream->epoch, stream->epoch + 1);
+    GLOOK_ATOMIC_STORE(&stream->tail, GLOOK_ATOMIC_LOAD(&stream->head));
+}
+
+static int glook_stream_update(struct stream* stream, const float t, const int wait)
+{
+    int ready, target, count;
+    while (!(ready = GLOOK_ATOMIC_LOAD(&stream->ready)) && wait) {
+        glook_sleep(0.001);
+    }
+
+    if (ready < 1) {
+        return 0;
+    }
+
+    /* the nudge keeps float times like 17 / 30 from rounding to the frame before */
+    count = stream->count;
+    target = (int)fmod(floor((double)t * stream->fps + 1e-3), (double)count);
+    target += target < 0 ? count : 0;
+    if (target == stream->shown) {
+        return 0;
+    }
+
+    /* live playback only takes what is ready, fixed timesteps wait for the frame */
+    while (1) {
+        const int cursor = GLOOK_ATOMIC_LOAD(&stream->cursor);
+        const int ack = GLOOK_ATOMIC_LOAD(&stream->ack);
+        const int head = GLOOK_ATOMIC_LOAD(&stream->head);
+        if (head != stream->tail) {
+            const int slot = stream->tail % GLOOK_STREAM_RING;
+            const int behind = (target - stream->frames[slot] + count) % count;
+            if (stream->epochs[slot] != stream->epoch ||
+                (behind && behind < GLOOK_STREAM_RING && behind <= count / 2)) {
+                GLOOK_ATOMIC_STORE(&stream->tail, stream->tail + 1);
+                continue;
+            }
+
+            if (!behind) {
+                const int resized = glook_stream_upload(
+                    stream, stream->slots + (size_t)slot * stream->width * stream->height * 4
+                );
+                GLOOK_ATOMIC_STORE(&stream->tail, stream->tail + 1);
+                stream->shown = target;
+                return resized;
+            }
+
+            /* far behind or ahead, early frames are kept when playing live */
+            if (behind <= count / 2 || wait || count - behind > GLOOK_STREAM_RING) {
+                glook_stream_seek(stream, target);
+            }
+            if (!wait) {
+                return 0;
+            }
+        } else if (!wait) {
+            return 0;
+        } else if (ack == stream->epoch &&
+            (target - cursor + count) % count >= GLOOK_STREAM_RING) {
+            glook_stream_seek(stream, target);
+        } else glook_sleep(0.001);
+    }
+}
+
+static int glook_stream_open(struct stream* stream, const char* path)
+{
+    memset(stream, 0, sizeof(struct stream));
+    stream->path = glook_strdup(path);
+    stream->sequence = strchr(path, '%') != NULL;
+    stream->fps = (double)glook.opts.fps;
+    stream->shown = -1;
+    if (pthread_create(&stream->thread, NULL, glook_stream_worker, stream)) {
+        glook_error_log("could not create a decoder thread for '%s'\n", path);
+        free(stream->path);
+        return EXIT_FAILURE;
+    }
+
+    stream->running = 1;
+    return EXIT_SUCCESS;
+}
+
+static void glook_stream_free(struct stream* stream)
+{
+    if (stream->running) {
+        GLOOK_ATOMIC_STORE(&stream->done, 1);
+        pthread_join(stream->thread, NULL);
+    }
+
+    if (stream->file) {
+        fclose(stream->file);
+    }
+
+    if (stream->pbos[0]) {
+        glDeleteBuffers(GLOOK_STREAM_PBOS, stream->pbos);
+    }
+
+    glDeleteTextures(1, &stream->texture.id);
+    free(stream->planes);
+    free(stream->slots);
+    free(stream->path);
+    memset(stream, 0, sizeof(struct stream));
+}
+
+/* radix-2 fast fourier transform over split real and imaginary arrays */
+
+static void glook_fft_tables(float* twr, float* twi, const int n)
+{
+    int h, k;
+    /* the twiddles of the stage with half size h are stored from index h - 1 */
+    for (h = 1; h < n; h *= 2) {
+        for (k = 0; k < h; ++k) {
+            const double a = -3.14159265358979323846 * (double)k / (double)h;
+            twr[h - 1 + k] = (float)cos(a);
+            twi[h - 1 + k] = (float)sin(a);
+        }
+    }
+}
+
+static void glook_fft_stage_scalar(float* re, float* im,
+    const float* twr, const float* twi, const int n, const int h)
+{
+    int b, j;
+    for (b = 0; b < n; b += h * 2) {
+        for (j = 0; j < h; ++j) {
+            const int p = b + j, q = p + h;
+            const float wr = twr[h - 1 + j], wi = twi[h - 1 + j];
+            const float tr = re[q] * wr - im[q] * wi, ti = re[q] * wi + im[q] * wr;
+            re[q] = re[p] - tr;
+            im[q] = im[p] - ti;
+            re[p] += tr;
+            im[p] += ti;
+        }
+    }
+}
+
+#ifdef GLOOK_SIMD_X86
+
+static void glook_fft_stage_sse2(float* re, float* im,
+    const float* twr, const float* twi, const int n, const int h)
+{
+    int b, j;
+    for (b = 0; b < n; b += h * 2) {
+        for (j = 0; j < h; j += 4) {
+            const int p = b + j, q = p + h;
+            const __m128 wr = _mm_loadu_ps(twr + h - 1 + j), wi = _mm_loadu_ps(twi + h - 1 + j);
+            const __m128 qr = _mm_loadu_ps(re + q), qi = _mm_loadu_ps(im + q);
+            const __m128 pr = _mm_loadu_ps(re + p), pi = _mm_loadu_ps(im + p);
+            const __m128 tr = _mm_sub_ps(_mm_mul_ps(qr, wr), _mm_mul_ps(qi, wi));
+            const __m128 ti = _mm_add_ps(_mm_mul_ps(qr, wi), _mm_mul_ps(qi, wr));
+            _mm_storeu_ps(re + q, _mm_sub_ps(pr, tr));
+            _mm_storeu_ps(im + q, _mm_sub_ps(pi, ti));
+            _mm_storeu_ps(re + p, _mm_add_ps(pr, tr));
+            _mm_storeu_ps(im + p, _mm_add_ps(pi, ti));
+        }
+    }
+}
+
+#endif /* GLOOK_SIMD_X86 */
+
+static void glook_fft(float* re, float* im, const float* twr, const float* twi, const int n)
+{
+    int i, j, h, bit;
+    for (i = 1, j = 0; i < n; ++i) {
+        for (bit = n >> 1; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j |= bit;
+        if (i < j) {
+            float t = re[i];
+            re[i] = re[j];
+            re[j] = t;
+            t = im[i];
+            im[i] = im[j];
+            im[j] = t;
+        }
+    }
+
+    /* the first two stages are too narrow for four lanes */
+    for (h = 1; h < n; h *= 2) {
+#ifdef GLOOK_SIMD_X86
+        if (h >= 4) {
+            glook_fft_stage_sse2(re, im, twr, twi, n, h);
+            continue;
+        }
+#endif
+        glook_fft_stage_scalar(re, im, twr, twi, n, h);
+    }
+}
+
+/* audio inputs, a wav file analyzed on a worker into a 512 x 2 spectrum and wave */
+
+static unsigned long glook_wav_u32(const unsigned char* p)
+{
+    return (unsigned long)p[0] | ((unsigned long)p[1] << 8) |
+        ((unsigned long)p[2] << 16) | ((unsigned long)p[3] << 24);
+}
+
+static float glook_audio_sample(const struct audio* audio, const long frame)
+{
+    int c;
+    float sum = 0.0F;
+    const int bytes = audio->bits / 8;
+    const unsigned char* p;
+    if (frame < 0 || frame >= audio->frames) {
+        return 0.0F;
+    }
+
+    /* channels are mixed down to mono, samples are little endian */
+    p = audio->samples + (size_t)frame * audio->channels * bytes;
+    for (c = 0; c < audio->channels; ++c, p += bytes) {
+        if (audio->isfloat) {
+            const unsigned int u = (unsigned int)glook_wav_u32(p);
+            float f;
+            memcpy(&f, &u, sizeof(float));
+            sum += f;
+        } else if (bytes == 1) {
+            sum += (float)(p[0] - 128) / 128.0F;
+        } else {
+            double s = (double)(p[bytes - 1] & 0x7F);
+            int k;
+            for (k = bytes - 2; k >= 0; --k) {
+                s = s * 256.0 + (double)p[k];
+            }
+            s -= p[bytes - 1] & 0x80 ? ldexp(1.0, bytes * 8 - 1) : 0.0;
+            sum += (float)ldexp(s, 1 - bytes * 8);
+        }
+    }
+    return sum / (float)audio->channels;
+}
+
+static void glook_audio_analyze(const struct audio* audio, const long frame, unsigned char* rows)
+{
+    float re[GLOOK_AUDIO_FFT], im[GLOOK_AUDIO_FFT];
+    const long start = frame - GLOOK_AUDIO_FFT;
+    int i;
+
+    for (i = 0; i < GLOOK_AUDIO_FFT; ++i) {
+        re[i] = glook_audio_sample(audio, start + i) * audio->window[i];
+        im[i] = 0.0F;
+    }
+
+    /* bytes from decibels in [-100, -30], the range of a web audio analyser */
+    glook_fft(re, im, audio->twr, audio->twi, GLOOK_AUDIO_FFT);
+    for (i = 0; i < GLOOK_AUDIO_WIDTH; ++i) {
+        const double mag = sqrt(re[i] * re[i] + im[i] * im[i]) / GLOOK_AUDIO_FFT;
+        const double db = mag > 0.0 ? 20.0 * log10(mag) : -100.0;
+        rows[i] = glook_clamp8((int)((db + 100.0) * 255.0 / 70.0));
+    }
+
+    /* the second row is the most recent stretch of the waveform */
+    for (i = 0; i < GLOOK_AUDIO_WIDTH; ++i) {
+        const float s = glook_audio_sample(audio, frame - GLOOK_AUDIO_WIDTH + i);
+        rows[GLOOK_AUDIO_WIDTH + i] = glook_clamp8((int)(128.0F + s * 127.0F + 0.5F));
+    }
+}
+
+static void* glook_audio_worker(void* data)
+{
+    long frame;
+    int slot;
+    struct audio* audio = (struct audio*)data;
+    pthread_mutex_lock(&audio->lock);
+    while (1) {
+        while (!audio->done && audio->request == audio->results[audio->published]) {
+            pthread_cond_wait(&audio->cond, &audio->lock);
+        }
+        if (audio->done) {
+            break;
+        }
+
+        /* the slot being written is never the published one the renderer copies */
+        frame = audio->request;
+        slot = !audio->published;
+        pthread_mutex_unlock(&audio->lock);
+        glook_audio_analyze(audio, frame, audio->rows[slot]);
+        pthread_mutex_lock(&audio->lock);
+        audio->results[slot] = frame;
+        audio->published = slot;
+        pthread_cond_broadcast(&audio->cond);
+    }
+
+    pthread_mutex_unlock(&audio->lock);
+    return NULL;
+}
+
+static int glook_audio_parse(struct audio* audio)
+{
+    const unsigned char* data = (const unsigned char*)audio->map;
+    size_t pos = 12, fmt = 0, length = 0;
+    int format = 0;
+
+    if (audio->mapsize < 12 || memcmp(data, "RIFF", 4) || memcmp(data + 8, "WAVE", 4)) {
+        glook_error_log("not a wav file: '%s'\n", audio->path);
+        return EXIT_FAILURE;
+    }
+
+    while (pos + 8 <= audio->mapsize) {
+        const size_t size = glook_wav_u32(data + pos + 4);
+        if (!memcmp(data + pos, "fmt ", 4) && size >= 16 && pos + 24 <= audio->mapsize) {
+            fmt = pos + 8;
+        } else if (!memcmp(data + pos, "data", 4)) {
+            audio->samples = data + pos + 8;
+            length = MIN(size, audio->mapsize - pos - 8);
+            break;
+        }
+        pos += 8 + size + (size & 1);
+    }
+
+    if (fmt) {
+        format = data[fmt] | (data[fmt + 1] << 8);
+        audio->channels = data[fmt + 2] | (data[fmt + 3] << 8);
+        audio->rate = (int)glook_wav_u32(data + fmt + 4);
+        audio->bits = data[fmt + 14] | (data[fmt + 15] << 8);
+        if (format == 0xFFFE && fmt + 26 <= audio->mapsize) {
+            /* extensible headers carry the real format in the subformat guid */
+            format = data[fmt + 24] | (data[fmt + 25] << 8);
+        }
+    }
+
+    audio->isfloat = format == 3;
+    if (!fmt || !audio->samples || audio->channels < 1 || audio->rate < 1 ||
+        (format != 1 && !(audio->isfloat && audio->bits == 32)) ||
+        audio->bits < 8 || audio->bits > 32 || audio->bits % 8) {
+        glook_error_log("unsupported wav format: '%s'\n", audio->path);
+        return EXIT_FAILURE;
+    }
+
+    audio->frames = (long)(length / ((size_t)audio->channels * (audio->bits / 8)));
+    return EXIT_SUCCESS;
+}
+
+static int glook_audio_open(struct audio* audio, const char* path)
+{
+    struct stat st;
+    int i, fd;
+    memset(audio, 0, sizeof(struct audio));
+    audio->path = glook_strdup(path);
+    audio->map = MAP_FAILED;
+    fd = open(path, O_RDONLY);
+    if (fd >= 0 && !fstat(fd, &st) && st.st_size > 0) {
+        audio->mapsize = st.st_size;
+        audio->map = mmap(NULL, audio->mapsize, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+
+    if (fd >= 0) {
+        close(fd);
+    }
+
+    if (audio->map == MAP_FAILED) {
+        glook_error_log("could not open audio: '%s'\n", path);
+        free(audio->path);
+        return EXIT_FAILURE;
+    }
+
+    if (glook_audio_parse(audio)) {
+        munmap(audio->map, audio->mapsize);
+        free(audio->path);
+        return EXIT_FAILURE;
+    }
+
+    /* hann window, results start out empty so the first request is always computed */
+    for (i = 0; i < GLOOK_AUDIO_FFT; ++i) {
+        const double a = 2.0 * 3.14159265358979323846 * (double)i / GLOOK_AUDIO_FFT;
+        audio->window[i] = (float)(0.5 - 0.5 * cos(a));
+    }
+    glook_fft_tables(audio->twr, audio->twi, GLOOK_AUDIO_FFT);
+    audio->results[0] = audio->results[1] = audio->shown = -1;
+    audio->request = -1;
+
+    pthread_mutex_init(&audio->lock, NULL);
+    pthread_cond_init(&audio->cond, NULL);
+    if (pthread_create(&audio->thread, NULL, glook_audio_worker, audio)) {
+        glook_error_log("could not create an audio thread for '%s'\n", path);
+        pthread_cond_destroy(&audio->cond);
+        pthread_mutex_destroy(&audio->lock);
+        munmap(audio->map, audio->mapsize);
+        free(audio->path);
+        return EXIT_FAILURE;
+    }
+
+    glGenTextures(1, &audio->texture.id);
+    glook_state_texture(glook.state.unit, audio->texture.id);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, GLOOK_AUDIO_WIDTH, 2, 0,
+        GL_RED, GL_UNSIGNED_BYTE, NULL
+    );
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    audio->texture.width = GLOOK_AUDIO_WIDTH;
+    audio->texture.height = 2;
+    audio->texture.format = GL_R8;
+    audio->running = 1;
+    return EXIT_SUCCESS;
+}
+
+static void glook_audio_update(struct audio* audio, const float t, const int wait)
+{
+    unsigned char rows[GLOOK_AUDIO_WIDTH * 2];
+    const long frame = (long)floor((double)t * audio->rate + 0.5);
+    int fresh = 0;
+
+    /* live playback shows the last finished analysis and never waits on the worker */
+    pthread_mutex_lock(&audio->lock);
+    if (audio->request != frame) {
+        audio->request = frame;
+        pthread_cond_broadcast(&audio->cond);
+    }
+    while (wait && audio->results[audio->published] != frame) {
+        pthread_cond_wait(&audio->cond, &audio->lock);
+    }
+    if (audio->results[audio->published] != audio->shown) {
+        audio->shown = audio->results[audio->published];
+        memcpy(rows, audio->rows[audio->published], sizeof(rows));
+        fresh = 1;
+    }
+    pthread_mutex_unlock(&audio->lock);
+
+    if (fresh) {
+        glook_state_texture(glook.state.unit, audio->texture.id);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, GLOOK_AUDIO_WIDTH, 2,
+            GL_RED, GL_UNSIGNED_BYTE, rows
+        );
+    }
+}
+
+static void glook_audio_free(struct audio* audio)
+{
+    if (audio->running) {
+        pthread_mutex_lock(&audio->lock);
+        audio->done = 1;
+        pthread_cond_broadcast(&audio->cond);
+        pthread_mutex_unlock(&audio->lock);
+        pthread_join(audio->thread, NULL);
+        pthread_cond_destroy(&audio->cond);
+        pthread_mutex_destroy(&audio->lock);
+        munmap(audio->map, audio->mapsize);
+        glDeleteTextures(1, &audio->texture.id);
+        free(audio->path);
+    }
+    memset(audio, 0, sizeof(struct audio));
+}
+
+/* image texture inputs, decoded on a worker and cached as raw mappable pixels */
+
+static size_t glook_image_size(const struct image* image)
+{
+    return (size_t)image->width * image->height * (image->hdr ? 4 * sizeof(float) : 4);
+}
+
+static void glook_image_cache_path(char* path, const char* fpath, const struct stat* st)
+{
+    unsigned long hash[2];
+    long stamp[2];
+
+    /* keyed on the source path, size and modification time */
+    stamp[0] = (long)st->st_mtime;
+    stamp[1] = (long)st->st_size;
+    glook_hash_init(hash);
+    glook_hash_update(hash, fpath, strlen(fpath));
+    glook_hash_update(hash, stamp, sizeof(stamp));
+    sprintf(path, "%s/%08lx%08lx.tex", glook.cachedir, hash[0], hash[1]);
+}
+
+static int glook_image_cache_load(struct image* image, const char* path)
+{
+    struct stat st;
+    unsigned int* header;
+    void* map;
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return EXIT_FAILURE;
+    }
+
+    if (fstat(fd, &st) || (size_t)st.st_size < GLOOK_IMAGE_HEADER) {
+        close(fd);
+        return EXIT_FAILURE;
+    }
+
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return EXIT_FAILURE;
+    }
+
+    header = (unsigned int*)map;
+    image->width = (int)header[1];
+    image->height = (int)header[2];
+    image->hdr = (int)header[3];
+    if (header[0] != GLOOK_IMAGE_MAGIC ||
+        (size_t)st.st_size != GLOOK_IMAGE_HEADER + glook_image_size(image)) {
+        munmap(map, st.st_size);
+        return EXIT_FAILURE;
+    }
+
+    image->map = map;
+    image->mapsize = st.st_size;
+    image->pixels = (unsigned char*)map + GLOOK_IMAGE_HEADER;
+    return EXIT_SUCCESS;
+}
+
+static void glook_image_cache_store(const struct image* image, const char* path)
+{
+    char tmp[BUFSIZE + 64];
+    unsigned int header[GLOOK_IMAGE_HEADER / sizeof(unsigned int)] = {0};
+    FILE* file;
+
+    header[0] = GLOOK_IMAGE_MAGIC;
+    header[1] = image->width;
+    header[2] = image->height;
+    header[3] = image->hdr;
+    sprintf(tmp, "%s.%ld", path, (long)getpid());
+    file = fopen(tmp, "wb");
+    if (file) {
+        int err = fwrite(header, sizeof(header), 1, file) != 1 ||
+            fwrite(image->pixels, glook_image_size(image), 1, file) != 1;
+        if (fclose(file) || err || rename(tmp, path)) {
+            remove(tmp);
+        }
+    }
+}
+
+static int glook_image_decode(struct image* image)
+{
+    char path[BUFSIZE + 32];
+    struct stat st;
+    unsigned char* data;
+    if (stat(image->path, &st) || !S_ISREG(st.st_mode)) {
+        glook_error_log("could not open image: '%s'\n", image->path);
+        return EXIT_FAILURE;
+    }
+
+    if (glook.cachedir[0]) {
+        glook_image_cache_path(path, image->path, &st);
+        if (!glook_image_cache_load(image, path)) {
+            return EXIT_SUCCESS;
+        }
+    }
+
+    data = (unsigned char*)glook_file_read(image->path, 0);
+    if (!data) {
+        return EXIT_FAILURE;
+    }
+
+    image->pixels = glook_image_read(
+        data, st.st_size, &image->width, &image->height, &image->hdr
+    );
+    free(data);
+    if (!image->pixels) {
+        glook_error_log("could not decode image: '%s'\n", image->path);
+        return EXIT_FAILURE;
+    }
+
+    if (glook.cachedir[0]) {
+        glook_image_cache_store(image, path);
+    }
+    return EXIT_SUCCESS;
+}
+
+static void glook_image_release(struct image* image)
+{
+    if (image->map) {
+        munmap(image->map, image->mapsize);
+    } else {
+        free(image->pixels);
+    }
+    image->map = image->pixels = NULL;
+}
+
+static void glook_image_upload(struct image* image)
+{
+    const size_t size = glook_image_size(image);
+    const unsigned int type = image->hdr ? GL_FLOAT : GL_UNSIGNED_BYTE;
+    const unsigned int format = image->hdr ? GL_RGBA16F : GL_RGBA8;
+    const double t = glook_clock();
+    unsigned int pbo;
+    void* dst;
+
+    /* staged through a pixel buffer so the copy to the texture is the driver's */
+    glGenBuffers(1, &pbo);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+    dst = glMapBufferRange(
+        GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT
+    );
+    if (dst) {
+        memcpy(dst, image->pixels, size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    } else glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    glook_state_texture(glook.state.unit, image->texture.id);
+    glTexImage2D(GL_TEXTURE_2D, 0, format, image->width, image->height, 0,
+        GL_RGBA, type, dst ? NULL : image->pixels
+    );
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glDeleteBuffers(1, &pbo);
+
+    image->texture.width = image->width;
+    image->texture.height = image->height;
+    image->texture.format = format;
+    glook_image_release(image);
+    glook_trace_span("upload", image->path, t);
+}
+
+static void* glook_loader_worker(void* data)
+{
+    int status;
+    struct image* image;
+    struct loader* loader = (struct loader*)data;
+    pthread_mutex_lock(&loader->lock);
+    while (1) {
+        while (!loader->count && !loader->done) {
+            pthread_cond_wait(&loader->cond, &loader->lock);
+        }
+        if (!loader->count) {
+            break;
+        }
+
+        image = loader->jobs[loader->head];
+        pthread_mutex_unlock(&loader->lock);
+        status = glook_image_decode(image) ? GLOOK_IMAGE_FAILED : GLOOK_IMAGE_DECODED;
+        pthread_mutex_lock(&loader->lock);
+        image->status = status;
+        loader->head = (loader->head + 1) % GLOOK_IMAGE_COUNT;
+        --loader->count;
+        pthread_cond_broadcast(&loader->cond);
+    }
+
+    pthread_mutex_unlock(&loader->lock);
+    return NULL;
+}
+
+static int glook_loader_push(struct loader* loader, struct image* image)
+{
+    if (!loader->running && !loader->failed) {
+        loader->head = loader->count = loader->done = 0;
+        pthread_mutex_init(&loader->lock, NULL);
+        pthread_cond_init(&loader->cond, NULL);
+        if (pthread_create(&loader->thread, NULL, glook_loader_worker, loader)) {
+            pthread_cond_destroy(&loader->cond);
+            pthread_mutex_destroy(&loader->lock);
+            glook_error_log("could not create an image loader thread, decoding in place\n");
+            loader->failed = 1;
+        } else loader->running = 1;
+    }
+
+    if (!loader->running) {
+        return EXIT_FAILURE;
+    }
+
+    pthread_mutex_lock(&loader->lock);
+    image->status = GLOOK_IMAGE_QUEUED;
+    loader->jobs[(loader->head + loader->count) % GLOOK_IMAGE_COUNT] = image;
+    ++loader->count;
+    pthread_cond_broadcast(&loader->cond);
+    pthread_mutex_unlock(&loader->lock);
+    return EXIT_SUCCESS;
+}
+
+static void glook_loader_placeholder(struct texture* texture, const int wrap)
+{
+    static const unsigned char black[4] = {0, 0, 0, 0xFF};
+    texture->width = texture->height = 1;
+    texture->format = GL_RGBA8;
+    glGenTextures(1, &texture->id);
+    glook_state_texture(glook.state.unit, texture->id);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, black);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+}
+
+static struct image* glook_loader_image(struct loader* loader, const char* path)
+{
+    struct image* image;
+    int i;
+    for (i = 0; i < loader->imagecount; ++i) {
+        if (!strcmp(loader->images[i].path, path)) {
+            return loader->images + i;
+        }
+    }
+
+    if (loader->imagecount == GLOOK_IMAGE_COUNT) {
+        glook_error_log("cannot load more than %d images at once\n", GLOOK_IMAGE_COUNT);
+        return NULL;
+    }
+
+    /* a black texel stands in until the decoded image is uploaded */
+    image = loader->images + loader->imagecount++;
+    memset(image, 0, sizeof(struct image));
+    image->path = glook_strdup(path);
+    glook_loader_placeholder(&image->texture, GL_REPEAT);
+
+    ++loader->pending;
+    if (glook_loader_push(loader, image)) {
+        image->status = glook_image_decode(image) ? GLOOK_IMAGE_FAILED : GLOOK_IMAGE_DECODED;
+    }
+    return image;
+}
+
+static struct stream* glook_loader_stream(struct loader* loader, const char* path)
+{
+    struct stream* stream;
+    int i;
+    for (i = 0; i < loader->streamcount; ++i) {
+        if (!strcmp(loader->streams[i].path, path)) {
+            return loader->streams + i;
+        }
+    }
+
+    if (loader->streamcount == GLOOK_STREAM_COUNT) {
+        glook_error_log("cannot stream more than %d videos at once\n", GLOOK_STREAM_COUNT);
+        return NULL;
+    }
+
+    if (strchr(path, '%') && glook_encoder_pattern(path)) {
+        glook_error_log(
+            "invalid image sequence pattern '%s' (expected one %%d field)\n", path
+        );
+        return NULL;
+    }
+
+    stream = loader->streams + loader->streamcount;
+    if (glook_stream_open(stream, path)) {
+        return NULL;
+    }
+
+    ++loader->streamcount;
+    glook_loader_placeholder(&stream->texture, GL_CLAMP_TO_EDGE);
+    return stream;
+}
+
+static struct audio* glook_loader_audio(struct loader* loader, const char* path)
+{
+    struct audio* audio;
+    int i;
+    for (i = 0; i < loader->audiocount; ++i) {
+        if (!strcmp(loader->audios[i].path, path)) {
+            return loader->audios + i;
+        }
+    }
+
+    if (loader->audiocount == GLOOK_AUDIO_COUNT) {
+        glook_error_log("cannot analyze more than %d audio files at once\n", GLOOK_AUDIO_COUNT);
+        return NULL;
+    }
+
+    audio = loader->audios + loader->audiocount;
+    if (glook_audio_open(audio, path)) {
+        return NULL;
+    }
+    ++loader->audiocount;
+    return audio;
+}
+
+static int glook_loader_play(struct loader* loader, const float t, const int wait)
+{
+    int i, resized = 0;
+    for (i = 0; i < loader->streamcount; ++i) {
+        resized += glook_stream_update(loader->streams + i, t, wait);
+    }
+    for (i = 0; i < loader->audiocount; ++i) {
+        glook_audio_update(loader->audios + i, t, wait);
+    }
+    return resized;
+}
+
+static int glook_loader_poll(struct loader* loader, const int wait)
+{
+    int i, status, uploaded = 0;
+    for (i = 0; i < loader->imagecount && loader->pending; ++i) {
+        struct image* image = loader->images + i;
+        if (loader->running) {
+            pthread_mutex_lock(&loader->lock);
+            while (wait && image->status == GLOOK_IMAGE_QUEUED) {
+                pthread_cond_wait(&loader->cond, &loader->lock);
+            }
+            status = image->status;
+            pthread_mutex_unlock(&loader->lock);
+        } else status = image->status;
+
+        /* failed images keep the placeholder and are not looked at again */
+        if (status == GLOOK_IMAGE_DECODED) {
+            glook_image_upload(image);
+            image->status = GLOOK_IMAGE_READY;
+            --loader->pending;
+            ++uploaded;
+        } else if (status == GLOOK_IMAGE_FAILED) {
+            image->status = GLOOK_IMAGE_NONE;
+            --loader->pending;
+        }
+    }
+
+    return uploaded;
+}
+
+static void glook_loader_free(struct loader* loader)
+{
+    int i;
+    if (loader->running) {
+        /* queued images are dropped, only the one being decoded is waited on */
+        pthread_mutex_lock(&loader->lock);
+        loader->count = MIN(loader->count, 1);
+        loader->done = 1;
+        pthread_cond_broadcast(&loader->cond);
+        pthread_mutex_unlock(&loader->lock);
+        pthread_join(loader->thread, NULL);
+        pthread_cond_destroy(&loader->cond);
+        pthread_mutex_destroy(&loader->lock);
+        loader->running = 0;
+    }
+
+    for (i = 0; i < loader->imagecount; ++i) {
+        struct image* image = loader->images + i;
+        glook_image_release(image);
+        glDeleteTextures(1, &image->texture.id);
+        free(image->path);
+    }
+
+    for (i = 0; i < loader->streamcount; ++i) {
+        glook_stream_free(loader->streams + i);
+    }
+    for (i = 0; i < loader->audiocount; ++i) {
+        glook_audio_free(loader->audios + i);
+    }
+    loader->imagecount = loader->pending = loader->streamcount = loader->audiocount = 0;
+}
+
+/* asynchronous program compilation, the previous program renders meanwhile */
+
+static void glook_program_issue(const struct program* program)
+{
+    const char* source = program->source;
+    glShaderSource(program->fshader, 1, &source, NULL);
+    glCompileShader(program->fshader);
+    glAttachShader(program->id, glook.vshader);
+    glAttachShader(program->id, program->fshader);
+    glLinkProgram(program->id);
+}
+
+static void* glook_compiler_worker(void* data)
+{
+    struct program* program;
+    struct compiler* compiler = (struct compiler*)data;
+    glfwMakeContextCurrent(compiler->context);
+    pthread_mutex_lock(&compiler->lock);
+    while (1) {
+        while (!compiler->count && !compiler->done) {
+            pthread_cond_wait(&compiler->cond, &compiler->lock);
+        }
+        if (!compiler->count) {
+            break;
+        }
+
+        program = compiler->jobs[compiler->head];
+        pthread_mutex_unlock(&compiler->lock);
+        glook_program_issue(program);
+        glFinish();
+        pthread_mutex_lock(&compiler->lock);
+        program->status = GLOOK_PROGRAM_ISSUED;
+        compiler->head = (compiler->head + 1) % GLOOK_SHADER_COUNT;
+        --compiler->count;
+        pthread_cond_broadcast(&compiler->cond);
+    }
+
+    pthread_mutex_unlock(&compiler->lock);
+    glfwMakeContextCurrent(NULL);
+    return NULL;
+}
+
+static int glook_compiler_create(struct compiler* compiler)
+{
+    if (!glook.window) {
+        return EXIT_FAILURE;
+    }
+
+    /* an invisible window sharing objects with the main context */
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    compiler->context = glfwCreateWindow(1, 1, "glook", NULL, glook.window);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+    if (!compiler->context) {
+        return EXIT_FAILURE;
+    }
+
+    compiler->head = compiler->count = compiler->done = 0;
+    pthread_mutex_init(&compiler->lock, NULL);
+    pthread_cond_init(&compiler->cond, NULL);
+    if (pthread_create(&compiler->thread, NULL, glook_compiler_worker, compiler)) {
+        pthread_cond_destroy(&compiler->cond);
+        pthread_mutex_destroy(&compiler->lock);
+        glfwDestroyWindow(compiler->context);
+        compiler->context = NULL;
+        return EXIT_FAILURE;
+    }
+
+    compiler->running = 1;
+    return EXIT_SUCCESS;
+}
+
+static void glook_compiler_free(struct compiler* compiler)
+{
+    if (!compiler->running) {
+        return;
+    }
+
+    /* the worker drains its queue before leaving */
+    pthread_mutex_lock(&compiler->lock);
+    compiler->done = 1;
+    pthread_cond_broadcast(&compiler->cond);
+    pthread_mutex_unlock(&compiler->lock);
+    pthread_join(compiler->thread, NULL);
+    pthread_cond_destroy(&compiler->cond);
+    pthread_mutex_destroy(&compiler->lock);
+    glfwDestroyWindow(compiler->context);
+    compiler->context = NULL;
+    compiler->running = 0;
+}
+
+static int glook_compiler_push(struct compiler* compiler, struct program* program)
+{
+    if (!compiler->running && (compiler->failed || glook_compiler_create(compiler))) {
+        if (!compiler->failed) {
+            glook_error_log("could not create a compiler context, compiling in place\n");
+        }
+        compiler->failed = 1;
+        return EXIT_FAILURE;
+    }
+
+    pthread_mutex_lock(&compiler->lock);
+    program->status = GLOOK_PROGRAM_QUEUED;
+    compiler->jobs[(compiler->head + compiler->count) % GLOOK_SHADER_COUNT] = program;
+    ++compiler->count;
+    pthread_cond_broadcast(&compiler->cond);
+    pthread_mutex_unlock(&compiler->lock);
+    return EXIT_SUCCESS;
+}
+
+static int glook_program_status(struct program* program, const int wait)
+{
+    int status;
+    struct compiler* compiler = &glook.compiler;
+    if (!compiler->running) {
+        return program->status;
+    }
+
+    pthread_mutex_lock(&compiler->lock);
+    while (wait && program->status == GLOOK_PROGRAM_QUEUED) {
+        pthread_cond_wait(&compiler->cond, &compiler->lock);
+    }
+    status = program->status;
+    pthread_mutex_unlock(&compiler->lock);
+    return status;
+}
+
+static void glook_program_begin(
+    struct program* program, char* source, const char* fpath, const int async)
+{
+    char path[BUFSIZE + 32];
+    double t;
+    program->source = source;
+    program->start = glook_clock();
+    program->id = glCreateProgram();
+    program->fshader = 0;
+    program->status = GLOOK_PROGRAM_ISSUED;
+    if (glook.cachedir[0] && glook.binaries) {
+        t = glook_clock();
+        glook_cache_path(path, source);
+        if (!glook_cache_load(program->id, path)) {
+            glook_trace_span("cache", fpath, t);
+            return;
+        }
+        glProgramParameteri(program->id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glook_trace_span("cache", fpath, t);
+    }
+
+    /* parallel compile drivers return immediately, otherwise hand it to the worker */
+    program->fshader = glCreateShader(GL_FRAGMENT_SHADER);
+    if (!async || glook.parallel || glook_compiler_push(&glook.compiler, program)) {
+        glook_program_issue(program);
+    }
+}
+
+static int glook_program_ready(struct program* program)
+{
+    int done = 1;
+    if (glook_program_status(program, 0) != GLOOK_PROGRAM_ISSUED) {
+        return 0;
+    }
+#ifdef GL_COMPLETION_STATUS_KHR
+    if (glook.parallel && program->fshader) {
+        glGetProgramiv(program->id, GL_COMPLETION_STATUS_KHR, &done);
+    }
+#endif
+    return done;
+}
+
+static unsigned int glook_program_end(struct program* program,
+    const char* fpath, const struct common* common, struct ulocator* locator)
+{
+    char log[LOGSIZE];
+    int success = 1;
+    unsigned int id = program->id;
+    double t;
+    glook_program_status(program, 1);
+    if (program->fshader) {
+        glGetShaderiv(program->fshader, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            glGetShaderInfoLog(program->fshader, LOGSIZE, NULL, log);
+            glook_compile_error_log(log, program->source, fpath, common);
+        } else {
+            glGetProgramiv(id, GL_LINK_STATUS, &success);
+            if (!success) {
+                glGetProgramInfoLog(id, LOGSIZE, NULL, log);
+                glook_compile_error_log(log, program->source, fpath, common);
+            } else if (glook.cachedir[0] && glook.binaries) {
+                char path[BUFSIZE + 32];
+                glook_cache_path(path, program->source);
+                glook_cache_store(id, path);
+            }
+        }
+        glDeleteShader(program->fshader);
+        glook_trace_span("compile", fpath, program->start);
+    }
+
+    program->id = program->fshader = 0;
+    program->status = GLOOK_PROGRAM_NONE;
+    if (!success) {
+        glDeleteProgram(id);
+        return 0;
+    }
+
+    t = glook_clock();
+    glook_state_program(id);
+    *locator = glook_shader_ulocator_create(id);
+    glook_trace_span("uniforms", fpath, t);
+    return id;
+}
+
+static void glook_program_free(struct program* program)
+{
+    if (program->status == GLOOK_PROGRAM_NONE) {
+        return;
+    }
+
+    glook_program_status(program, 1);
+    if (program->fshader) {
+        glDeleteShader(program->fshader);
+    }
+    glDeleteProgram(program->id);
+    free(program->source);
+    memset(program, 0, sizeof(struct program));
+}
+
+static unsigned int glook_shader_program_create(const char* buf,
+    const char* fpath, const struct common* common, struct ulocator* locator)
+{
+    struct program program;
+    glook_program_begin(&program, (char*)(size_t)buf, fpath, 0);
+    return glook_program_end(&program, fpath, common, locator);
+}
+
+/* shader lifetime */
+
+static void glook_shader_free(struct shader* shader)
+{
+    glook_timer_free(&shader->timer, shader->fpath);
+    if (shader->fpath) {
+        free(shader->fpath);
+    }
+    if (shader->id) {
+        glDeleteProgram(shader->id);
+    }
+    if (shader->ubo) {
+        glDeleteBuffers(1, &shader->ubo);
+    }
+    glook_pool_release(&glook.pool, &shader->framebuffer);
+    glook_pool_release(&glook.pool, &shader->history);
+    glook_program_free(&shader->pending);
+    memset(shader, 0, sizeof(struct shader));
+}
+
+static struct shader glook_shader_load_buffer(const char* buf, char* fpath,
+    const struct common* common, const unsigned int format, const int width, const int height)
+{
+    struct shader shader = {0};
+    shader.id = glook_shader_program_create(buf, fpath, common, &shader.locator);
+    if (shader.id) {
+        const double t = glook_clock();
+        shader.fpath = fpath;
+        shader.framebuffer = glook_pool_acquire(&glook.pool, width, height, format);
+        glook_trace_span("framebuffer", fpath, t);
+    }
+    return shader;
+}
+
+static struct shader glook_shader_load(char* fpath, struct common* common,
+    const unsigned int format, const struct resolution* resolution)
+{
+    int width, height;
+    char* filebuf;
+    struct resolution target;
+    struct shader shader = {0};
+    filebuf = glook_file_shader_read(fpath, common);
+    if (filebuf) {
+        target = glook_shader_target(resolution, filebuf + common->length);
+        glook_resolution_size(&target, &width, &height);
+        shader = glook_shader_load_buffer(filebuf, fpath, common,
+            glook_shader_format(format, filebuf + common->length), width, height
+        );
+        shader.format = format;
+        shader.resolution = *resolution;
+        shader.target = target;
+        glook_hash_string(shader.hash, filebuf + common->length);
+        memcpy(shader.commonhash, common->hash, sizeof(shader.commonhash));
+        free(filebuf);
+    }
+
+    return shader;
+}
+
+static int glook_shader_reload(struct shader* shader, const int force)
+{
+    unsigned long hash[2];
+    const struct common* common = &shader->pipeline->common;
+    char* filebuf = glook_file_shader_read(shader->fpath, common);
+    if (!filebuf) {
+        return EXIT_FAILURE;
+    }
+
+    /* every pass is prefixed with the common header, so both hashes must match */
+    glook_hash_string(hash, filebuf + common->length);
+    if (!force && glook_hash_equal(hash, shader->hash) &&
+        glook_hash_equal(common->hash, shader->commonhash)) {
+        free(filebuf);
+        return EXIT_SUCCESS;
+    }
+
+    glook_program_begin(&shader->pending, filebuf, shader->fpath, 1);
+    shader->pending.format = glook_shader_format(shader->format, filebuf + common->length);
+    shader->pending.target = glook_shader_target(&shader->resolution, filebuf + common->length);
+    memcpy(shader->pending.hash, hash, sizeof(hash));
+    memcpy(shader->pending.commonhash, common->hash, sizeof(shader->pending.commonhash));
+    return EXIT_SUCCESS;
+}
+
+static int glook_shader_retarget(struct shader* shader,
+    const int width, const int height, const unsigned int format)
+{
+    return glook_framebuffer_realloc(&shader->framebuffer, width, height, format) |
+        glook_framebuffer_realloc(&shader->history, width, height, format);
+}
+
+static void glook_shader_swap(struct shader* shader)
+{
+    struct ulocator locator;
+    struct program* program = &shader->pending;
+    const unsigned int id = glook_program_end(
+        program, shader->fpath, &shader->pipeline->common, &locator
+    );
+
+    /* the render target, inputs and timers survive, only the program changes */
+    if (id) {
+        int width, height;
+        glook_resolution_size(&program->target, &width, &height);
+        glook_shader_retarget(shader, width, height, program->format);
+        shader->target = program->target;
+        glDeleteProgram(shader->id);
+        shader->id = id;
+        shader->locator = locator;
+        memcpy(shader->hash, program->hash, sizeof(shader->hash));
+        memcpy(shader->commonhash, program->commonhash, sizeof(shader->commonhash));
+    }
+
+    free(program->source);
+    memset(program, 0, sizeof(struct program));
+}
+
+/* pipeline shader utils */
+
+static struct shader* glook_pipeline_head(struct pipeline* pipeline)
+{
+    return pipeline->shaders + MIN(pipeline->count - 1, (int)glook.opts.limit);
+}
+
+static struct texture* glook_shader_input_texture(struct input input)
+{
+    switch (input.type) {
+        case GLOOK_FRAMEBUFFER:
+            return &((struct shader*)input.data)->framebuffer.texture;
+        case GLOOK_TEXTURE:
+            return input.data ? &((struct image*)input.data)->texture : NULL;
+        case GLOOK_STREAM:
+            return input.data ? &((struct stream*)input.data)->texture : NULL;
+        case GLOOK_AUDIO:
+            return input.data ? &((struct audio*)input.data)->texture : NULL;
+    }
+
+    glook_error_log("invalid input type with value: %d\n", input.type);
+    return NULL;
+}
+
+static void glook_shader_region(struct shader* shader,
+    const int width, const int height, const double x, const double y)
+{
+    int i;
+    struct upass upass;
+    const struct texture* texture;
+    memset(&upass, 0, sizeof(struct upass));
+    upass.iResolution[0] = (float)width;
+    upass.iResolution[1] = (float)height;
+    upass.iResolution[2] = 1.0F;
+    upass.offset[0] = (float)x;
+    upass.offset[1] = (float)y;
+    for (i = 0; i < shader->inputcount; ++i) {
+        texture = glook_shader_input_texture(shader->inputs[i]);
+        if (texture) {
+            upass.iChannelResolution[i][0] = (float)texture->width;
+            upass.iChannelResolution[i][1] = (float)texture->height;
+            upass.iChannelResolution[i][2] = 1.0F;
+        }
+    }
+
+    if (!shader->ubo) {
+        glGenBuffers(1, &shader->ubo);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, shader->ubo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(struct upass), &upass, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+static void glook_shader_draw(const struct command* command, const struct framebuffer* target)
+{
+    int i;
+    struct shader* shader = command->shader;
+
+    /* the triangle covers every pixel of the target, nothing needs clearing */
+    glook_state_framebuffer(GL_FRAMEBUFFER, target->fbo);
+    glook_state_viewport(target->texture.width, target->texture.height);
+    for (i = 0; i < GLOOK_INPUT_COUNT; ++i) {
+        const struct texture* texture = i < shader->inputcount ? command->bindings[i] : NULL;
+        glook_state_texture(i, texture ? texture->id : 0);
+    }
+
+    glook_state_program(shader->id);
+    glBindBufferBase(GL_UNIFORM_BUFFER, GLOOK_UBO_PASS, shader->ubo);
+    if (glook.opts.dperf || glook.trace.file || glook.dynres.level) {
+        glook_timer_begin(&shader->timer, shader->fpath);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glook_timer_end(&shader->timer);
+    } else glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+static void glook_shader_render(const struct command* command)
+{
+    struct shader* shader = command->shader;
+
+    /* feedback passes flip targets, last frame becomes the one read from */
+    if (shader->history.fbo) {
+        struct framebuffer fb = shader->history;
+        shader->history = shader->framebuffer;
+        shader->framebuffer = fb;
+    }
+    glook_shader_draw(command, &shader->framebuffer);
+}
+
+/* render graph, compiled into a flat list of passes in dependency order */
+
+static void glook_graph_visit(struct graph* graph, struct shader* shader, char* marks)
+{
+    int i;
+    struct command* command;
+    struct pipeline* pipeline = shader->pipeline;
+    const int index = (int)(shader - pipeline->shaders);
+
+    /* 1 while the pass is on the stack, 2 once it and its inputs are scheduled */
+    marks[index] = 1;
+    for (i = 0; i < shader->inputcount; ++i) {
+        const struct input* input = shader->inputs + i;
+        if (input->type == GLOOK_FRAMEBUFFER) {
+            const int n = (int)((struct shader*)input->data - pipeline->shaders);
+            if (n < pipeline->count && !marks[n]) {
+                glook_graph_visit(graph, input->data, marks);
+            }
+        }
+    }
+
+    marks[index] = 2;
+    command = graph->commands + graph->count++;
+    command->shader = shader;
+    for (i = 0; i < shader->inputcount; ++i) {
+        const struct input input = shader->inputs[i];
+        const int n = (int)((struct shader*)input.data - pipeline->shaders);
+        if (input.type != GLOOK_FRAMEBUFFER) {
+            command->bindings[i] = glook_shader_input_texture(input);
+        } else if (n >= pipeline->count) {
+            glook_error_log("pass %d reads missing pass %d on channel %d\n", index, n, i);
+            command->bindings[i] = NULL;
+        } else if (input.data == shader) {
+            command->bindings[i] = &shader->history.texture;
+        } else {
+            /* a back edge is bound before its pass renders, so it reads last frame */
+            if (marks[n] == 1) {
+                glook_log("feedback edge: pass %d reads pass %d from the previous frame\n",
+                    index, n
+                );
+            }
+            command->bindings[i] = glook_shader_input_texture(input);
+        }
+    }
+}
+
+static void glook_shader_pipeline_compile(struct pipeline* pipeline, struct shader* head)
+{
+    char marks[GLOOK_SHADER_COUNT] = {0};
+    struct graph* graph = &pipeline->graph;
+    graph->head = head;
+    graph->count = 0;
+    glook_graph_visit(graph, head, marks);
+    if (glook.opts.dperf && graph->count < pipeline->count) {
+        glook_log("culled %d of %d passes not reachable from pass %d\n",
+            pipeline->count - graph->count, pipeline->count, (int)(head - pipeline->shaders)
+        );
+    }
+}
+
+/* supersampled export, jittered samples of the output pass are summed in a float target */
+
+static int glook_accum_create(const struct shader* shader)
+{
+    const int w = shader->framebuffer.texture.width, h = shader->framebuffer.texture.height;
+
+    /* sized like the pass target, so memory does not grow with the sample count */
+    if (glook.accum.texture.width != w || glook.accum.texture.height != h) {
+        glook_framebuffer_free(&glook.accum);
+        glook.accum = glook_framebuffer_create(w, h, GL_RGBA32F);
+    }
+    return !glook.accum.fbo;
+}
+
+static void glook_accum_render(const struct command* command,
+    const int width, const int height, const int x, const int y)
+{
+    static const float zero[4] = {0.0F, 0.0F, 0.0F, 0.0F};
+    struct shader* shader = command->shader;
+    const int w = shader->framebuffer.texture.width, h = shader->framebuffer.texture.height;
+    const float weight = 1.0F / (float)glook.opts.spp;
+    const double t = glook_clock();
+    unsigned int i;
+
+    glook_state_framebuffer(GL_FRAMEBUFFER, glook.accum.fbo);
+    glClearBufferfv(GL_COLOR, 0, zero);
+    glEnable(GL_BLEND);
+    glBlendColor(weight, weight, weight, weight);
+    glBlendFunc(GL_CONSTANT_COLOR, GL_ONE);
+    for (i = 0; i < glook.opts.spp; ++i) {
+        /* r2 sequence offsets, the first sample sits on the pixel center */
+        const double jx = fmod(0.5 + i * GLOOK_R2_X, 1.0) - 0.5;
+        const double jy = fmod(0.5 + i * GLOOK_R2_Y, 1.0) - 0.5;
+        glook_shader_region(shader, width, height, x + jx, y + jy);
+        glook_shader_draw(command, &glook.accum);
+    }
+    glDisable(GL_BLEND);
+
+    /* resolved once into the pass target, where readback and tiling expect it */
+    glook_state_framebuffer(GL_READ_FRAMEBUFFER, glook.accum.fbo);
+    glook_state_framebuffer(GL_DRAW_FRAMEBUFFER, shader->framebuffer.fbo);
+    glBlitFramebuffer(0, 0, w, h, 0, 0, w, h, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glook_shader_region(shader, width, height, x, y);
+    glook_trace_span("samples", NULL, t);
+}
+
+/* tiled export, the output pass is rendered and written one row of tiles at a time */
+
+static int glook_tiler_create(struct tiler* tiler, const char* path,
+    const unsigned int format, const int size, const int width, const int height)
+{
+    const char* ext = strrchr(path, '.');
+    const int png = ext && !strcmp(ext, ".png");
+    const int frames = glook.opts.frames[1] - glook.opts.frames[0];
+    switch (format) {
+        case GLOOK_EXPORT_RAW:
+            tiler->file = strcmp(path, "-") ? fopen(path, "wb") : stdout;
+            if (!tiler->file) {
+                glook_error_log("could not open output file: '%s'\n", path);
+                return EXIT_FAILURE;
+            }
+            break;
+        case GLOOK_EXPORT_PNG:
+            if (!png) {
+                glook_error_log("tiled image sequences are written as png, not '%s'\n", path);
+                return EXIT_FAILURE;
+            }
+            if (glook_encoder_pattern(path)) {
+                glook_error_log(
+                    "invalid image sequence pattern '%s' (expected one %%d field)\n", path
+                );
+                return EXIT_FAILURE;
+            }
+            break;
+        case GLOOK_EXPORT_Y4M:
+            /* without a %d pattern only a single .png image can be tiled */
+            if (!png) {
+                glook_error_log("tiled exports write png images or -raw frames, not '%s'\n", path);
+                return EXIT_FAILURE;
+            }
+            if (strlen(path) >= BUFSIZE) {
+                glook_error_log("output path is too long: '%s'\n", path);
+                return EXIT_FAILURE;
+            }
+            if (frames > 1) {
+                glook_error_log("'%s' holds a single frame, use a %%d pattern for more\n", path);
+                return EXIT_FAILURE;
+            }
+            break;
+        default:
+            glook_error_log("tiled exports cannot write qoi images: '%s'\n", path);
+            return EXIT_FAILURE;
+    }
+
+    /* memory is one row of tiles plus a scanline, whatever the output size */
+    tiler->format = format == GLOOK_EXPORT_RAW ? GLOOK_EXPORT_RAW : GLOOK_EXPORT_PNG;
+    tiler->path = path;
+    tiler->size = size;
+    tiler->width = width;
+    tiler->height = height;
+    tiler->rows = (unsigned char*)malloc((size_t)width * MIN(size, height) * 4);
+    if (tiler->format == GLOOK_EXPORT_PNG) {
+        tiler->line = (unsigned char*)malloc((size_t)width * 4 + 1);
+        tiler->idat = (unsigned char*)malloc(GLOOK_TILE_IDAT);
+    }
+
+    if (!tiler->rows || (tiler->format == GLOOK_EXPORT_PNG && (!tiler->line || !tiler->idat))) {
+        glook_error_log("could not allocate a row of %d x %d tiles\n", width, MIN(size, height));
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+static int glook_tiler_begin(struct tiler* tiler, const int frame)
+{
+    char path[BUFSIZE + 16];
+    int len;
+    if (tiler->format != GLOOK_EXPORT_PNG) {
+        return !tiler->file;
+    }
+
+    /* the pattern was validated on creation, it only ever holds one %d field */
+    len = strchr(tiler->path, '%') ?
+        snprintf(path, sizeof(path), tiler->path, frame) :
+        snprintf(path, sizeof(path), "%s", tiler->path);
+    if (len < 0 || len >= (int)sizeof(path)) {
+        glook_error_log("output path for frame %d is too long: '%s'\n", frame, tiler->path);
+        return EXIT_FAILURE;
+    }
+
+    tiler->file = fopen(path, "wb");
+    if (!tiler->file) {
+        glook_error_log("could not open output file: '%s'\n", path);
+        return EXIT_FAILURE;
+    }
+
+    memset(&tiler->zs, 0, sizeof(z_stream));
+    deflateInit(&tiler->zs, Z_BEST_SPEED);
+    tiler->zs.next_out = tiler->idat;
+    tiler->zs.avail_out = GLOOK_TILE_IDAT;
+    glook_png_header(tiler->file, tiler->width, tiler->height);
+    return EXIT_SUCCESS;
+}
+
+static void glook_tiler_write(struct tiler* tiler, const unsigned char* row, const int last)
+{
+    const int stride = tiler->width * 4;
+    if (tiler->format != GLOOK_EXPORT_PNG) {
+        fwrite(row, 1, stride, tiler->file);
+        return;
+    }
+
+    /* scanlines are deflated as they arrive, full buffers become IDAT chunks */
+    glook_png_filter(tiler->line, row, stride);
+    tiler->zs.next_in = tiler->line;
+    tiler->zs.avail_in = stride + 1;
+    while (1) {
+        const int status = deflate(&tiler->zs, last ? Z_FINISH : Z_NO_FLUSH);
+        if (!tiler->zs.avail_out || (last && status == Z_STREAM_END)) {
+            glook_png_chunk(tiler->file, "IDAT", tiler->idat,
+                GLOOK_TILE_IDAT - tiler->zs.avail_out
+            );
+            tiler->zs.next_out = tiler->idat;
+            tiler->zs.avail_out = GLOOK_TILE_IDAT;
+        }
+        if (last ? status == Z_STREAM_END || status < 0 :
+            !tiler->zs.avail_in && tiler->zs.avail_out) {
+            break;
+        }
+    }
+}
+
+static int glook_tiler_end(struct tiler* tiler)
+{
+    int err;
+    if (tiler->format != GLOOK_EXPORT_PNG) {
+        return fflush(tiler->file) || ferror(tiler->file);
+    }
+
+    glook_png_chunk(tiler->file, "IEND", NULL, 0);
+    deflateEnd(&tiler->zs);
+    err = ferror(tiler->file);
+    err = fclose(tiler->file) || err;
+    tiler->file = NULL;
+    return err;
+}
+
+static void glook_tiler_render(
+    struct tiler* tiler, const struct command* command, const int frame)
+{
+    int x, y, i, row;
+    struct shader* shader = command->shader;
+    const int w = shader->framebuffer.texture.width, h = shader->framebuffer.texture.height;
+    const unsigned int layout = glook_format_get(shader->framebuffer.texture.format)->layout;
+    const double t = glook_clock();
+    if (glook.opts.spp && glook_accum_create(shader)) {
+        glook_error_log("no accumulation target for frame %d, it is missing from the export\n", frame);
+        tiler->failed = 1;
+        return;
+    }
+    if (glook_tiler_begin(tiler, frame)) {
+        tiler->failed = 1;
+        return;
+    }
+
+    /* the bottom-up tile grid is walked from the top row so files come out in order */
+    for (y = (tiler->height - 1) / h * h; y >= 0; y -= h) {
+        const int th = MIN(h, tiler->height - y);
+        for (x = 0; x < tiler->width; x += w) {
+            if (glook.opts.spp) {
+                glook_accum_render(command, tiler->width, tiler->height, x, y);
+            } else {
+                glook_shader_region(shader, tiler->width, tiler->height, x, y);
+                glook_shader_render(command);
+            }
+            glook_state_framebuffer(GL_READ_FRAMEBUFFER, shader->framebuffer.fbo);
+            glPixelStorei(GL_PACK_ALIGNMENT, 1);
+            glPixelStorei(GL_PACK_ROW_LENGTH, tiler->width);
+            glReadPixels(0, 0, MIN(w, tiler->width - x), th, GL_RGBA, GL_UNSIGNED_BYTE,
+                tiler->rows + (size_t)x * 4
+            );
+            glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+        }
+
+        for (row = th - 1; row >= 0; --row) {
+            unsigned char* line = tiler->rows + (size_t)row * tiler->width * 4;
+            for (i = 0; i < tiler->width * 4; i += 4) {
+                if (layout == GL_RED) {
+                    line[i + 1] = line[i + 2] = line[i];
+                }
+                if (layout == GL_RED || tiler->format == GLOOK_EXPORT_PNG) {
+                    line[i + 3] = 0xFF;
+                }
+            }
+            glook_tiler_write(tiler, line, !y && !row);
+        }
+    }
+
+    if (glook_tiler_end(tiler)) {
+        glook_error_log("could not write tiled frame %d\n", frame);
+        tiler->failed = 1;
+    }
+    glook_shader_region(shader, w, h, 0, 0);
+    glook_trace_span("tiles", NULL, t);
+}
+
+static int glook_tiler_free(struct tiler* tiler)
+{
+    const int failed = tiler->failed;
+    if (tiler->file && tiler->file != stdout) {
+        fclose(tiler->file);
+    }
+    free(tiler->rows);
+    free(tiler->line);
+    free(tiler->idat);
+    memset(tiler, 0, sizeof(struct tiler));
+    return failed;
+}
+
+/* pipeline and shader arrays */
+
+static struct input glook_shader_input(void *data)
+{
+    struct input input;
+    input.type = GLOOK_FRAMEBUFFER;
+    input.data = data;
+    return input;
+}
+
+static struct input glook_image_input(const char* path)
+{
+    struct input input;
+    const char* ext = strrchr(path, '.');
+    if (strchr(path, '%') || (ext && !strcmp(ext, ".y4m"))) {
+        /* numbered image sequences and videos play back along iTime */
+        input.type = GLOOK_STREAM;
+        input.data = glook_loader_stream(&glook.loader, path);
+    } else if (ext && !strcmp(ext, ".wav")) {
+        input.type = GLOOK_AUDIO;
+        input.data = glook_loader_audio(&glook.loader, path);
+    } else {
+        input.type = GLOOK_TEXTURE;
+        input.data = glook_loader_image(&glook.loader, path);
+    }
+    return input;
+}
+
+static int glook_input_parse(char* fpath, char** path, char* inputs,
+    char** images, unsigned int* format, struct resolution* resolution)
+{
+    static const char* div = ";:,";
+    char* tok;
+    int inputcount = 0;
+    *path = strtok(fpath, div);
+    while ((tok = strtok(NULL, div))) {
+        if (strchr(tok, '.')) {
+            /* anything with an extension is an image file read as a texture */
+            if (inputcount >= GLOOK_INPUT_COUNT) {
+                glook_error_log(
+                    "cannot link to more than %d inputs\n", GLOOK_INPUT_COUNT
+                );
+                break;
+            }
+            images[inputcount++] = tok;
+            continue;
+        }
+
+        if (isalpha((unsigned char)*tok)) {
+            *format = glook_format_find(tok);
+            if (!*format) {
+                glook_error_log(
+                    "unknown format '%s': must be rgba8, rgba16f, r32f or rgba32f\n", tok
+                );
+            }
+            continue;
+        }
+
+        if (strpbrk(tok, "/x")) {
+            if (glook_resolution_parse(tok, resolution)) {
+                glook_error_log("invalid resolution '%s': must be N/D or WxH\n", tok);
+            }
+            continue;
+        }
+
+        if (inputcount >= GLOOK_INPUT_COUNT) {
+            glook_error_log(
+                "cannot link to more than %d inputs\n", GLOOK_INPUT_COUNT
+            );
+            break;
+        }
+    
+        while (*tok) {
+            if (*tok < '0' || *tok > GLOOK_SHADER_COUNT + '0') {
+                 glook_error_log(
+                    "invalid input channel %d: must be in range (0 - %d)\n", 
+                    *tok, GLOOK_SHADER_COUNT
+                );
+            } else if (inputcount < GLOOK_INPUT_COUNT) {
+                inputs[inputcount++] = *tok;
+            }
+            ++tok;
+        }
+    }
+
+    return inputcount;
+}
+
+static int glook_shader_input_connect(struct shader* shader,
+    const int index, const char* inputs, char** images, int inputcount)
+{
+    int i = 1;
+    struct pipeline* pipeline = shader->pipeline;
+    if (inputcount) {
+        for (i = 0; i < inputcount; ++i) {
+            int n = inputs[i] - '0';
+            shader->inputs[i] = images[i] ? glook_image_input(images[i]) :
+                glook_shader_input(pipeline->shaders + n);
+        }
+    } else if (glook.opts.mode == GLOOK_MODE_CHAIN && index) {
+        shader->inputs[0] = glook_shader_input(pipeline->shaders + index - 1);
+    } else if (glook.opts.mode >= GLOOK_MODE_DIRECT) {
+        int n = glook.opts.mode - GLOOK_MODE_DIRECT;
+        shader->inputs[0] = glook_shader_input(pipeline->shaders + n); 
+    } else {
+        for (i = 0; i < index; ++i) {
+            shader->inputs[i] = glook_shader_input(pipeline->shaders + i);
+        }
+    }
+
+    return i;
+}
+
+static int glook_pipeline_push(struct pipeline* pipeline, char* fpath)
+{
+    int i, inputcount;
+    unsigned int format = 0;
+    struct resolution resolution = {0, 0, 0, 0};
+    struct shader shader;
+    char *path, inputs[GLOOK_INPUT_COUNT] = {0}, *images[GLOOK_INPUT_COUNT] = {0};
+    if (pipeline->count >= GLOOK_SHADER_COUNT) {
+        glook_error_log(
+            "cannot pipeline more than %d shaders at once\n", GLOOK_SHADER_COUNT
+        );
+        return EXIT_FAILURE;
+    }
+
+    inputcount = glook_input_parse(fpath, &path, inputs, images, &format, &resolution);
+    shader = glook_shader_load(path, &pipeline->common, format, &resolution);
+    if (shader.id) {
+        shader.pipeline = pipeline;
+        shader.inputcount = glook_shader_input_connect(
+            &shader, pipeline->count, inputs, images, inputcount
+        );
+        for (i = 0; i < shader.inputcount; ++i) {
+            if (shader.inputs[i].data == pipeline->shaders + pipeline->count) {
+                /* reading itself, keep the previous frame in a second target */
+                const struct texture* texture = &shader.framebuffer.texture;
+                shader.history = glook_pool_acquire(
+                    &glook.pool, texture->width, texture->height, texture->format
+                );
+                break;
+            }
+        }
+        pipeline->shaders[pipeline->count++] = shader;
+        pipeline->graph.head = NULL;
+    }
+
+    return !shader.id * 2;
+}
+
+static void glook_shader_resolution(struct shader* shader)
+{
+    const struct texture* texture = &shader->framebuffer.texture;
+    glook_shader_region(shader, texture->width, texture->height, 0, 0);
+}
+
+static void glook_shader_pipeline_resolution(struct pipeline* pipeline)
+{
+    int i;
+    /* inputs may point anywhere in the pipeline, so resolve sizes once all exist */
+    for (i = 0; i < pipeline->count; ++i) {
+        glook_shader_resolution(pipeline->shaders + i);
+    }
+}
+
+static int glook_shader_pipeline_load(
+    struct pipeline* pipeline, char* commonpath)
+{
+    int i, err = 0;
+    pipeline->common = glook_common_create(commonpath);
+    for (i = 0; i < glook.filecount; ++i) {
+        if (glook_pipeline_push(pipeline, glook.filepaths[i])) {
+            free(glook.filepaths[i]);
+            ++err;
+        } 
+        glook.filepaths[i] = NULL;
+    }
+    glook.filecount = 0;
+    glook_shader_pipeline_resolution(pipeline);
+    return err;
+}
+
+static int glook_shader_pipeline_reload(struct pipeline* pipeline, const int force)
+{
+    int i, err;
+    for (i = 0; i < pipeline->count; ++i) {
+        if (pipeline->shaders[i].pending.status) {
+            /* reload again once the compiles in flight are swapped in */
+            pipeline->stale = force ? 2 : MAX(pipeline->stale, 1);
+            return EXIT_SUCCESS;
+        }
+    }
+
+    err = glook_common_reload(&pipeline->common);
+    for (i = 0; i < pipeline->count; ++i) {
+        err += glook_shader_reload(pipeline->shaders + i, force);
+    }
+    return err;
+}
+
+static int glook_shader_pipeline_poll(struct pipeline* pipeline)
+{
+    int i, stale, swapped = 0;
+    for (i = 0; i < pipeline->count; ++i) {
+        struct program* program = &pipeline->shaders[i].pending;
+        if (program->status && !glook_program_ready(program)) {
+            return 0;
+        }
+    }
+
+    /* swap every finished pass in the same frame so the pipeline stays consistent */
+    for (i = 0; i < pipeline->count; ++i) {
+        if (pipeline->shaders[i].pending.status) {
+            glook_shader_swap(pipeline->shaders + i);
+            ++swapped;
+        }
+    }
+
+    if (swapped) {
+        glook_shader_pipeline_resolution(pipeline);
+    }
+
+    stale = pipeline->stale;
+    pipeline->stale = 0;
+    if (stale) {
+        glook_shader_pipeline_reload(pipeline, stale > 1);
+        return 0;
+    }
+    return 1;
+}
+
+static int glook_shader_pipeline_resize(struct pipeline* pipeline)
+{
+    int i, width, height, limit = 0, err = EXIT_SUCCESS;
+    const struct resolution output = {0, 0, 0, 0};
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &limit);
+    for (i = 0; i < pipeline->count; ++i) {
+        struct shader* shader = pipeline->shaders + i;
+        glook_resolution_size(&shader->target, &width, &height);
+        if (glook.tiler.size && shader == glook_pipeline_head(pipeline)) {
+            /* a tiled export only ever holds one tile of the output pass */
+            width = MIN(width, glook.tiler.size);
+            height = MIN(height, glook.tiler.size);
+        } else if (glook.tiler.size && (width > limit || height > limit)) {
+            /* inputs can be read anywhere from any tile, so they stay whole */
+            glook_error_log(
+                "pass '%s' needs a %d x %d target, larger than the %d limit of the driver\n",
+                shader->fpath, width, height, limit
+            );
+            err = EXIT_FAILURE;
+            continue;
+        }
+
+        if (glook_shader_retarget(shader, width, height, shader->framebuffer.texture.format) &&
+            glook.tiler.size) {
+            glook_error_log("could not allocate a %d x %d target for pass '%s'\n",
+                width, height, shader->fpath
+            );
+            err = EXIT_FAILURE;
+        }
+    }
+
+    glook_resolution_size(&output, &width, &height);
+    glook_pool_trim(&glook.pool, width, height);
+    glook_shader_pipeline_resolution(pipeline);
+    return err;
+}
+
+static void glook_shader_pipeline_free(struct pipeline* pipeline)
+{
+    int i;
+    for (i = 0; i < pipeline->count; ++i) {
+        glook_shader_free(pipeline->shaders + i);
+    }
+    
+    glook_common_free(&pipeline->common);
+    memset(pipeline, 0, sizeof(struct pipeline));
+}
+
+static void glook_shader_pipeline_render(
+    struct pipeline* pipeline, int frame, float t, float dt, float* mouse)
+{
+    int i, dropped = 0;
+    const double start = glook_clock();
+    struct shader* shader = glook_pipeline_head(pipeline);
+    if (glook.loader.pending && glook_loader_poll(&glook.loader, 0)) {
+        glook_shader_pipeline_resolution(pipeline);
+    }
+    if ((glook.loader.streamcount || glook.loader.audiocount) &&
+        glook_loader_play(&glook.loader, t, !glook.ubuffer.live)) {
+        glook_shader_pipeline_resolution(pipeline);
+    }
+    if (pipeline->graph.head != shader) {
+        glook_shader_pipeline_compile(pipeline, shader);
+    }
+
+    glook_ubuffer_update(&glook.ubuffer, frame, t, dt, mouse);
+    for (i = 0; i < pipeline->graph.count; ++i) {
+        const struct command* command = pipeline->graph.commands + i;
+        if (command->shader != shader) {
+            glook_shader_render(command);
+        } else if (glook.tiler.size) {
+            glook_tiler_render(&glook.tiler, command, frame);
+        } else if (!glook.opts.spp) {
+            glook_shader_render(command);
+        } else if (glook_accum_create(shader)) {
+            /* a single sample is not what was asked for, the frame is dropped instead */
+            glook_readback_drop(&glook.readback, frame, "no accumulation target for");
+            dropped = 1;
+        } else {
+            const struct texture* texture = &shader->framebuffer.texture;
+            glook_accum_render(command, texture->width, texture->height, 0, 0);
+        }
+    }
+    if (glook.readback.format && !dropped) {
+        glook_readback_push(&glook.readback, &shader->framebuffer, frame);
+    }
+
+    if (!glook.opts.headless) {
+        const int width = glook.width * GLOOK_SCALE, height = glook.height * GLOOK_SCALE;
+        glook_state_framebuffer(GL_FRAMEBUFFER, 0);
+        glook_state_viewport(width, height);
+        glook_state_texture(0, shader->framebuffer.texture.id);
+        glook_state_program(glook.shaderpass.id);
+        glUniform3f(glook.shaderpass.locator.iResolution, (float)width, (float)height, 1.0F);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+
+    glook_trace_span("render", NULL, start);
+}
+
+static void glook_shader_pipeline_stats_log(struct pipeline* pipeline, const int frame)
+{
+    int i;
+    float min, max, avg = glook_stats_get(&glook.framestats, &min, &max);
+    FILE* stream = glook_log_stream();
+    glook_log("frame: %d\t%d x %d\tfps: %.2f\t(ms: min / avg / max)\n",
+        frame, glook.width * GLOOK_SCALE, glook.height * GLOOK_SCALE,
+        avg > 0.0F ? 1000.0F / avg : 0.0F
+    );
+
+    for (i = 0; i < pipeline->count; ++i) {
+        const struct shader* shader = pipeline->shaders + i;
+        if (shader->timer.stats.count) {
+            avg = glook_stats_get(&shader->timer.stats, &min, &max);
+            fprintf(stream, "  #%d\tgpu  %8.3f %8.3f %8.3f\t%s\n",
+                i, min, avg, max, shader->fpath
+            );
+        }
+    }
+
+    if (glook.swapstats.count) {
+        avg = glook_stats_get(&glook.swapstats, &min, &max);
+        fprintf(stream, "  swap\tcpu  %8.3f %8.3f %8.3f\n", min, avg, max);
+    }
+
+    avg = glook_stats_get(&glook.framestats, &min, &max);
+    fprintf(stream, "  frame\tcpu  %8.3f %8.3f %8.3f\n", min, avg, max);
+}
+
+/* mouse control functions */
+
+static unsigned int glook_mouse_down(unsigned int button)
+{
+    return glook.mouse[button];
+}
+
+static unsigned int glook_mouse_pressed(unsigned int button)
+{
+    unsigned int held = glfwGetMouseButton(glook.window, button);
+    unsigned int pressed = (held == GLFW_PRESS && glook.mouse[button] == GLFW_RELEASE);
+    glook.mouse[button] = held;
+    return pressed;
+}
+
+static void glook_mouse_pos(float* x, float* y)
+{
+    double mx, my, scale = (float)GLOOK_SCALE;
+    glfwGetCursorPos(glook.window, &mx, &my);
+    *x = (float)mx * scale;
+    *y = (float)(glook.height - (float)my) * scale;
+}
+
+static void glook_mouse_get(float* mouse)
+{
+    int pressed = glook_mouse_pressed(GLFW_MOUSE_BUTTON_LEFT);
+    int down = glook_mouse_down(GLFW_MOUSE_BUTTON_LEFT);
+    mouse[2] = (float)((down * 2 - 1) * mouse[0]);
+    mouse[3] = (float)((pressed * 2 - 1) * mouse[1]);
+    if (down) {
+        glook_mouse_pos(mouse, mouse + 1);
+    }
+}
+
+/* keyboard control functions */
+
+static unsigned int glook_key_down(unsigned int key)
+{
+    return glook.keys[key];
+}
+
+static unsigned int glook_key_pressed(unsigned int key)
+{
+    unsigned int pressed = glook.keys_pressed[key];
+    glook.keys_pressed[key] = 0;
+    return pressed;
+}
+
+static void glook_keyboard_callback(
+    GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+    (void)mods;
+    (void)window;
+    (void)scancode;
+    glook.keys_pressed[key] = (char)(!glook.keys[key] && !!action);
+    glook.keys[key] = (char)!!action;
+}
+
+/* file paths and droped files handling */
+
+static void glook_filepaths_free(void)
+{
+    int i;
+    for (i = 0; glook.filepaths[i] && i < GLOOK_FILE_COUNT; ++i) {
+        free(glook.filepaths[i]);
+        glook.filepaths[i] = NULL;
+    }
+}
+
+static int glook_filepaths_push(const char* str)
+{
+    if (glook.filecount == GLOOK_FILE_COUNT) {
+        glook_error_log("cannot open more than %d files\n", GLOOK_FILE_COUNT);
+        return EXIT_FAILURE;
+    }
+    glook.filepaths[glook.filecount++] = glook_strdup(str);
+    return EXIT_SUCCESS;
+}
+
+static void glook_file_drop(struct pipeline* pipeline)
+{
+    int i;
+    for (i = 0; i < glook.filecount; ++i) {
+        if (glook_pipeline_push(pipeline, glook.filepaths[i]) == EXIT_FAILURE) {
+            free(pipeline->shaders[pipeline->count - 1].fpath);
+            pipeline->shaders[pipeline->count - 1].fpath = glook.filepaths[i];
+        }
+        glook.filepaths[i] = NULL;
+    }
+    glook.filecount = 0;
+    glook_shader_pipeline_resolution(pipeline);
+}
+
+static void glook_file_drop_callback(GLFWwindow* window, int count, const char** paths)
+{
+    int i;
+    (void)window;
+    for (i = 0; i < count; i++) {
+        if (glook_filepaths_push(paths[i])) {
+            break;
+        }
+    }
+}
+
+/* file watching */
+
+static time_t glook_file_mtime(const char* fpath)
+{
+    struct stat st;
+    return stat(fpath, &st) ? 0 : st.st_mtime;
+}
+
+static void glook_watcher_add(struct watcher* watcher, const char* path)
+{
+    struct watch* watch = watcher->watches + watcher->count++;
+    const char* name = strrchr(path, '/');
+    watch->wd = -1;
+    watch->path = path;
+    watch->name = name ? name + 1 : path;
+    watch->mtime = glook_file_mtime(path);
+
+#ifdef __linux__
+    if (watcher->fd >= 0) {
+        /* watch the directory so atomic rename saves replacing the file are seen */
+        char dir[BUFSIZE];
+        const size_t len = name ? (size_t)(name - path) : 0;
+        if (len >= BUFSIZE) {
+            return;
+        }
+        memcpy(dir, path, len);
+        strcpy(dir + len, name ? (len ? "" : "/") : ".");
+        watch->wd = inotify_add_watch(
+            watcher->fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_MODIFY
+        );
+        if (watch->wd < 0) {
+            glook_error_log("could not watch directory '%s': %s\n", dir, strerror(errno));
+        }
+    }
+#endif
+}
+
+static void glook_watcher_free(struct watcher* watcher)
+{
+    if (watcher->fd >= 0) {
+        close(watcher->fd);
+    }
+    watcher->fd = -1;
+    watcher->count = 0;
+}
+
+static void glook_watcher_create(struct watcher* watcher, const struct pipeline* pipeline)
+{
+    int i;
+    memset(watcher, 0, sizeof(struct watcher));
+    watcher->fd = -1;
+    watcher->polled = glook_clock();
+#ifdef __linux__
+    watcher->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watcher->fd < 0) {
+        glook_error_log("could not initialize inotify, polling files instead\n");
+    }
+#endif
+
+    for (i = 0; i < pipeline->count; ++i) {
+        glook_watcher_add(watcher, pipeline->shaders[i].fpath);
+    }
+    if (pipeline->common.path) {
+        glook_watcher_add(watcher, pipeline->common.path);
+    }
+}
+
+static void glook_watcher_touch(struct watcher* watcher, const double now)
+{
+    watcher->dirty = 1;
+    watcher->last = now;
+}
+
+#ifdef __linux__
+static void glook_watcher_read(struct watcher* watcher, const double now)
+{
+    int i;
+    ssize_t size;
+    const char* p;
+    const struct inotify_event* event;
+    union {
+        struct inotify_event event;
+        char bytes[4096];
+    } buf;
+
+    while ((size = read(watcher->fd, buf.bytes, sizeof(buf))) > 0) {
+        for (p = buf.bytes; p < buf.bytes + size; p += sizeof(struct inotify_event) + event->len) {
+            event = (const struct inotify_event*)p;
+            if (event->mask & IN_Q_OVERFLOW) {
+                glook_watcher_touch(watcher, now);
+                continue;
+            }
+            for (i = 0; i < watcher->count; ++i) {
+                if (watcher->watches[i].wd == event->wd && event->len &&
+                    !strcmp(watcher->watches[i].name, event->name)) {
+                    glook_watcher_touch(watcher, now);
+                    break;
+                }
+            }
+        }
+    }
+}
+#endif
+
+static int glook_watcher_poll(struct watcher* watcher)
+{
+    int i;
+    const double now = glook_clock();
+#ifdef __linux__
+    if (watcher->fd >= 0) {
+        glook_watcher_read(watcher, now);
+    } else
+#endif
+    if (now - watcher->polled >= GLOOK_WATCH_POLL) {
+        watcher->polled = now;
+        for (i = 0; i < watcher->count; ++i) {
+            const time_t mtime = glook_file_mtime(watcher->watches[i].path);
+            if (mtime != watcher->watches[i].mtime) {
+                watcher->watches[i].mtime = mtime;
+                glook_watcher_touch(watcher, now);
+            }
+        }
+    }
+
+    /* coalesce bursts of events from a single save into one reload */
+    if (watcher->dirty && now - watcher->last >= GLOOK_WATCH_DELAY) {
+        watcher->dirty = 0;
+        return 1;
+    }
+    return 0;
+}
+
+/* window and OpenGL buffers */
+
+static void glook_window_size_callback(GLFWwindow* window, int width, int height)
+{
+    (void)window;
+    if (width < 1 || height < 1) {
+        return;
+    }
+
+    /* targets are reallocated once the size settles, see glook_run */
+    glook.width = width;
+    glook.height = height;
+    glook.resized = glook_clock();
+}
+
+static unsigned int glook_buffer_triangle_create(void)
+{
+    /* the fullscreen triangle is generated from gl_VertexID, core still wants a vao */
+    unsigned int id;
+    glGenVertexArrays(1, &id);
+    glBindVertexArray(id);
+    return id;
+}
+
+static int glook_window_create(
+    const char* title, int width, int height, unsigned int fullscreen)
+{
+    GLFWwindow* window;
+    if (width < 1 || height < 1) {
+        glook_error_log("invalid resolution: %d x %d\n", width, height);
+        return EXIT_FAILURE;
+    }
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_SAMPLES, 4);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);    
+    glfwWindowHint(GLFW_COCOA_RETINA_FRAMEBUFFER, GLFW_TRUE);
+    glfwWindowHint(GLFW_COCOA_GRAPHICS_SWITCHING, GLFW_TRUE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
+#endif
+
+    if (glook.opts.bench) {
+        glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+        fullscreen = 0;
+    }
+
+    if (fullscreen) {
+        GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+        const GLFWvidmode* mode = glfwGetVideoMode(monitor);
+        glfwWindowHint(GLFW_RED_BITS, mode->redBits);
+        glfwWindowHint(GLFW_GREEN_BITS, mode->greenBits);
+        glfwWindowHint(GLFW_BLUE_BITS, mode->blueBits);
+        glfwWindowHint(GLFW_REFRESH_RATE, mode->refreshRate);
+        window = glfwCreateWindow(mode->width, mode->height, title,monitor, NULL);
+        glook.width = mode->width;
+        glook.height = mode->height;
+    } else {
+        window = glfwCreateWindow(width, height, title, NULL, NULL);
+        glook.width = width;
+        glook.height = height;
+    }
+
+    if (window == NULL) {
+        glook_error_log("could not open a glfw window\n");
+        glfwTerminate();
+        return EXIT_FAILURE;
+    }
+
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(!glook.opts.bench);
+
+    glfwSetWindowAspectRatio(window, width, height);
+    glfwSetWindowSizeCallback(window, glook_window_size_callback);
+    glfwSetDropCallback(window, glook_file_drop_callback);
+    glfwSetKeyCallback(window, glook_keyboard_callback);
+    glook.window = window;
+    return EXIT_SUCCESS;
+}
+
+static int glook_headless_create(int width, int height)
+{
+#ifndef __APPLE__
+    static const EGLint config_attribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    static const EGLint pbuffer_attribs[] = {
+        EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE
+    };
+
+    EGLint major, minor, count = 0;
+    EGLConfig config = NULL;
+    EGLDisplay display = EGL_NO_DISPLAY;
+    const char* ext = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (width < 1 || height < 1) {
+        glook_error_log("invalid resolution: %d x %d\n", width, height);
+        return EXIT_FAILURE;
+    }
+
+    /* prefer Mesa's surfaceless platform, it needs no display or GPU device */
+#ifdef EGL_MESA_platform_surfaceless
+    if (ext && strstr(ext, "EGL_MESA_platform_surfaceless")) {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getdisplay;
+        getdisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)(size_t)eglGetProcAddress(
+            "eglGetPlatformDisplayEXT"
+        );
+        if (getdisplay) {
+            display = getdisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+        }
+    }
+#endif
+
+    if (display == EGL_NO_DISPLAY) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        glook_error_log("could not initiate an egl display\n");
+        return EXIT_FAILURE;
+    }
+
+    glook.egldisplay = display;
+    if (!eglBindAPI(EGL_OPENGL_API) ||
+        !eglChooseConfig(display, config_attribs, &config, 1, &count) || !count) {
+        glook_error_log("could not find an egl config for desktop opengl\n");
+        return EXIT_FAILURE;
+    }
+
+    glook.eglcontext = eglCreateContext(display, config, EGL_NO_CONTEXT, NULL);
+    if (glook.eglcontext == EGL_NO_CONTEXT) {
+        glook_error_log("could not create a headless opengl context\n");
+        return EXIT_FAILURE;
+    }
+
+    ext = eglQueryString(display, EGL_EXTENSIONS);
+    glook.eglsurface = EGL_NO_SURFACE;
+    if (!ext || !strstr(ext, "EGL_KHR_surfaceless_context")) {
+        glook.eglsurface = eglCreatePbufferSurface(display, config, pbuffer_attribs);
+    }
+
+    if (!eglMakeCurrent(display, glook.eglsurface, glook.eglsurface, glook.eglcontext)) {
+        glook_error_log("could not make the headless opengl context current\n");
+        return EXIT_FAILURE;
+    }
+
+    glook.width = width;
+    glook.height = height;
+    return EXIT_SUCCESS;
+#else
+    /* no EGL on macOS, an invisible window provides the context instead */
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    return glook_window_create("glook", width, height, 0);
+#endif
+}
+
+static void glook_headless_destroy(void)
+{
+#ifndef __APPLE__
+    if (glook.egldisplay == EGL_NO_DISPLAY) {
+        return;
+    }
+
+    eglMakeCurrent(glook.egldisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (glook.eglsurface != EGL_NO_SURFACE) {
+        eglDestroySurface(glook.egldisplay, glook.eglsurface);
+    }
+    if (glook.eglcontext != EGL_NO_CONTEXT) {
+        eglDestroyContext(glook.egldisplay, glook.eglcontext);
+    }
+    eglTerminate(glook.egldisplay);
+    glook.egldisplay = EGL_NO_DISPLAY;
+#endif
+}
+
+static int glook_gl_init(void)
+{
+#ifndef __APPLE__
+    unsigned int err;
+    glewExperimental = GL_TRUE;
+    err = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    /* glew built against glx reports this with egl contexts, entry points are loaded */
+    if (err == GLEW_ERROR_NO_GLX_DISPLAY) {
+        err = GLEW_OK;
+    }
+#endif
+    if (err != GLEW_OK) {
+        glook_error_log("failed to initiate glew\n");
+        return EXIT_FAILURE;
+    }
+
+#ifdef GLEW_KHR_parallel_shader_compile
+    if (GLEW_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        glook.parallel = 1;
+    }
+#endif
+#endif
+
+    glook_state_viewport(glook.width * GLOOK_SCALE, glook.height * GLOOK_SCALE);
+    glook_buffer_triangle_create();
+    glook.vshader = glCreateShader(GL_VERTEX_SHADER);
+    glook_shader_compile(glook.vshader, glook_shader_string_triangle, NULL, NULL);
+    glook_ubuffer_create(&glook.ubuffer);
+    glook_cache_init();
+    return EXIT_SUCCESS;
+}
+
+/* main glook utilities and abstractions */
+
+static float glook_time(void)
+{
+    return (float)glfwGetTime();
+}
+
+static float glook_frame_time(int frame)
+{
+    return (float)frame / (float)glook.opts.fps;
+}
+
+static int glook_clear(void)
+{
+    const double t = glook_clock();
+    glfwSwapBuffers(glook.window);
+    glfwPollEvents();
+    glook_trace_span("swap", NULL, t);
+    if (glook.opts.dperf) {
+        glook_stats_push(&glook.swapstats, (float)((glook_clock() - t) * 1000.0));
+    }
+    return !glfwWindowShouldClose(glook.window);
+}
+
+static int glook_deinit(void)
+{ 
+    int err;
+    glook_filepaths_free();
+    glook_compiler_free(&glook.compiler);
+    glook_loader_free(&glook.loader);
+    glook_shader_pipeline_free(&glook.pipeline);
+    if (glook.vshader) {
+        glDeleteShader(glook.vshader);
+    }
+
+    /* frames lost anywhere in an export surface here as a failed run */
+    err = glook_readback_free(&glook.readback);
+    err |= glook_tiler_free(&glook.tiler);
+    glook_framebuffer_free(&glook.accum);
+    glook_ubuffer_free(&glook.ubuffer);
+    glook_trace_free(&glook.trace);
+    glook_shader_free(&glook.shaderpass);
+    glook_pool_free(&glook.pool);
+    if (glook.opts.headless) {
+        glook_headless_destroy();
+    }
+    glfwTerminate();
+    return err ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+static int glook_init(int width, int height, int fullscreen, char* commonpath,
+    const char* outpath, unsigned int outformat, const char* tracepath)
+{
+    int err;
+    double t;
+    if (!glook.filecount) {
+        glook_error_log("no input files\n");
+        return EXIT_FAILURE;
+    }
+
+    if (tracepath && glook_trace_create(&glook.trace, tracepath)) {
+        glook_filepaths_free();
+        return EXIT_FAILURE;
+    }
+
+#ifndef __APPLE__
+    glook.egldisplay = EGL_NO_DISPLAY;
+    if (!glook.opts.headless && !glfwInit()) {
+#else
+    if (!glfwInit()) {
+#endif
+        glook_error_log("failed to initiate glfw\n");
+        glook_filepaths_free();
+        glook_trace_free(&glook.trace);
+        return EXIT_FAILURE;
+    }
+
+    t = glook_clock();
+    if (glook.opts.headless) {
+        err = glook_headless_create(width, height);
+    } else {
+        if (outpath) {
+            /* exported frames keep the size they started with */
+            glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+        }
+        err = glook_window_create("glook", width, height, fullscreen);
+    }
+
+    if (err || glook_gl_init()) {
+        glook_deinit();
+        return EXIT_FAILURE;
+    }
+
+    if (glook.trace.file) {
+        glook_trace_calibrate(&glook.trace);
+    }
+    glook_trace_span("context", NULL, t);
+
+    /* passes are first created at tile size, only the inputs of the output pass are
+     * grown to their full size, the output pass itself is never poster sized */
+    if (glook.opts.tile) {
+        glook.width = MIN(glook.width, glook.opts.tile);
+        glook.height = MIN(glook.height, glook.opts.tile);
+    }
+
+    glook_shader_pipeline_load(&glook.pipeline, commonpath);
+    if (!glook.pipeline.count) {
+        glook_error_log("could not succesfully compile any shader\n");
+        glook_deinit();
+        return EXIT_FAILURE;
+    }
+
+    glook.shaderpass.id = glook_shader_program_create(
+        glook_shader_string_pass, NULL, NULL, &glook.shaderpass.locator
+    );
+    glook.opts.limit = GLOOK_SHADER_COUNT - 1;
+    if ((glook.opts.tile || glook.opts.spp) &&
+        glook_pipeline_head(&glook.pipeline)->history.fbo) {
+        glook_error_log("the output pass reads itself and cannot be tiled or supersampled\n");
+        glook_deinit();
+        return EXIT_FAILURE;
+    }
+
+    if (glook.opts.tile) {
+        glook.width = width;
+        glook.height = height;
+        if (glook_tiler_create(&glook.tiler, outpath, outformat, glook.opts.tile,
+            width * GLOOK_SCALE, height * GLOOK_SCALE)) {
+            glook_deinit();
+            return EXIT_FAILURE;
+        }
+        if (glook_shader_pipeline_resize(&glook.pipeline)) {
+            glook_error_log("give the input passes a smaller resolution to export tiles\n");
+            glook_deinit();
+            return EXIT_FAILURE;
+        }
+        outpath = NULL;
+    }
+
+    if (outpath && glook_readback_create(&glook.readback, outpath, outformat,
+        glook.width * GLOOK_SCALE, glook.height * GLOOK_SCALE)) {
+        glook_deinit();
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/* dynamic resolution, scales every pass to hold the gpu frame time under a budget */
+
+static int glook_dynres_update(struct dynres* dynres, struct pipeline* pipeline)
+{
+    int i, level = dynres->level, samples = 0;
+    float ratio, min, max, avg, gpu = 0.0F;
+    for (i = 0; i < pipeline->count; ++i) {
+        struct timer* timer = &pipeline->shaders[i].timer;
+        if (timer->last > 0.0F) {
+            gpu += timer->last;
+            timer->last = 0.0F;
+            ++samples;
+        }
+    }
+
+    if (!samples) {
+        return 0;
+    }
+
+    glook_stats_push(&dynres->stats, gpu);
+    if (dynres->stats.count < GLOOK_DYNRES_FRAMES) {
+        return 0;
+    }
+
+    /* step down as soon as the budget is nearly used, step up only when the
+     * larger size is predicted to fit with a clear margin to avoid oscillation */
+    avg = glook_stats_get(&dynres->stats, &min, &max);
+    ratio = (float)(level + 1) / (float)level;
+    if (avg > dynres->target * 0.9F && level > GLOOK_DYNRES_MIN) {
+        --level;
+    } else if (level < GLOOK_DYNRES_STEPS && avg * ratio * ratio < dynres->target * 0.75F) {
+        ++level;
+    } else return 0;
+
+    if (glook.opts.dperf) {
+        glook_log("resolution scale %.3f -> %.3f, gpu %.3f ms of %.3f ms\n",
+            (float)dynres->level / GLOOK_DYNRES_STEPS, (float)level / GLOOK_DYNRES_STEPS,
+            avg, dynres->target
+        );
+    }
+
+    /* start measuring from scratch at the new size */
+    dynres->level = level;
+    dynres->stats.head = dynres->stats.count = 0;
+    return 1;
+}
+
+static void glook_run(void)
+{
+    struct watcher watcher;
+    unsigned int i, frame = 0, reload = 0, full = 0, pause = 0;
+    float mouse[4], cursor[4], t = 0.0F, dt = 1.0F, T = 0.0F, tzero = 0.0F, pt = 0.0F;
+
+    glook.ubuffer.live = 1;
+    if (glook.opts.autoreload) {
+        glook_watcher_create(&watcher, &glook.pipeline);
+    }
+
+    while (glook_clear()) {
+        if (glook_key_pressed(GLFW_KEY_ESCAPE)) {
+            break;
+        }
+        if (glook_key_pressed(GLFW_KEY_R)) {
+            ++reload;
+            ++full;
+        }
+        if (glook_key_pressed(GLFW_KEY_T)) {
+            tzero = t;
+            frame = 0;
+        }
+        if (glook_key_pressed(GLFW_KEY_SPACE)) {
+            pause = !pause;
+        }
+        if (glook_key_pressed(GLFW_KEY_I)) {
+            glook_log(
+                "\niFrame: %u\niTime: %f\niResolution: %u x %u\niMouse: %.2f x %.2f\n",
+                frame, t, glook.width * GLOOK_SCALE, glook.height * GLOOK_SCALE,
+                mouse[0], mouse[1]
+            );
+        }
+        if (glook.pipeline.count > 1 && glook_key_pressed(GLFW_KEY_BACKSPACE)) {
+            glook_shader_free(glook.pipeline.shaders + --glook.pipeline.count);
+            glook.pipeline.graph.head = NULL;
+            if (glook.opts.autoreload) {
+                glook_watcher_free(&watcher);
+                glook_watcher_create(&watcher, &glook.pipeline);
+            }
+        }
+
+        if (glook.opts.autoreload && glook_watcher_poll(&watcher)) {
+            ++reload;
+        }
+
+        for (i = 0; i < GLOOK_SHADER_COUNT; ++i) {
+            if (glook_key_pressed(i + 48)) {
+                glook.opts.limit = i;
+                break;
+            }
+        }
+
+        if (glook.filepaths[0]) {
+            glook_file_drop(&glook.pipeline);
+            if (glook.opts.autoreload) {
+                glook_watcher_free(&watcher);
+                glook_watcher_create(&watcher, &glook.pipeline);
+            }
+            ++reload;
+        }
+
+        if (reload) {
+            const double start = glook_clock();
+            glook_shader_pipeline_reload(&glook.pipeline, full);
+            glook_trace_span("reload", NULL, start);
+            reload = 0;
+        }
+
+        if (glook.resized && glook_clock() - glook.resized >= GLOOK_RESIZE_DELAY) {
+            glook_shader_pipeline_resize(&glook.pipeline);
+            glook.resized = 0.0;
+        }
+
+        if (glook.dynres.level && glook_dynres_update(&glook.dynres, &glook.pipeline)) {
+            glook_shader_pipeline_resize(&glook.pipeline);
+        }
+
+        if (glook_shader_pipeline_poll(&glook.pipeline) && full) {
+            tzero = t;
+            frame = 0;
+            full = 0;
+        }
+
+        if (glook.opts.dperf && frame && !(frame % GLOOK_STATS_COUNT)) {
+            glook_shader_pipeline_stats_log(&glook.pipeline, frame);
+        }
+
+        if (pause) {
+            pt = glook_time() - t;
+            continue;
+        }
+
+        t = glook_time() - pt;
+        dt = t - T;
+        T = t;
+        t -= tzero;
+        if (glook.opts.dperf) {
+            glook_stats_push(&glook.framestats, dt * 1000.0F);
+        }
+
+        glook_mouse_get(mouse);
+        for (i = 0; i < 4; ++i) {
+            /* iMouse stays in the pixel space of fragCoord when scaled down */
+            cursor[i] = !glook.dynres.level ? mouse[i] :
+                mouse[i] * (float)glook.dynres.level / GLOOK_DYNRES_STEPS;
+        }
+        glook_shader_pipeline_render(&glook.pipeline, frame++, t, dt, cursor);
+    }
+
+    if (glook.opts.autoreload) {
+        glook_watcher_free(&watcher);
+    }
+}
+
+static void glook_run_frames(void)
+{
+    int frame;
+    double T = glook_clock();
+    float mouse[4] = {0.0F, 0.0F, 0.0F, 0.0F};
+    const float dt = 1.0F / (float)glook.opts.fps;
+
+    /* fixed timestep frames never render with placeholder textures */
+    if (glook_loader_poll(&glook.loader, 1)) {
+        glook_shader_pipeline_resolution(&glook.pipeline);
+    }
+
+    for (frame = glook.opts.frames[0]; frame < glook.opts.frames[1]; ++frame) {
+        const float t = glook_frame_time(frame);
+        glook_shader_pipeline_render(&glook.pipeline, frame, t, dt, mouse);
+        if (!glook.opts.headless && (!glook_clear() || glook_key_pressed(GLFW_KEY_ESCAPE))) {
+            break;
+        }
+
+        if (glook.opts.dperf) {
+            const double now = glook_clock();
+            glook_stats_push(&glook.framestats, (float)((now - T) * 1000.0));
+            T = now;
+            if (frame > glook.opts.frames[0] && !(frame % GLOOK_STATS_COUNT)) {
+                glook_shader_pipeline_stats_log(&glook.pipeline, frame);
+            }
+        }
+    }
+
+    glFinish();
+    if (glook.opts.dperf) {
+        glook_shader_pipeline_stats_log(&glook.pipeline, frame);
+    }
+}
+
+static int glook_frames_parse(const char* str, int* frames)
+{
+    int n;
+    if (sscanf(str, "%d:%d%n", frames, frames + 1, &n) < 2 || str[n] ||
+        frames[0] < 0 || frames[1] <= frames[0]) {
+        glook_error_log("invalid frame range: '%s' (expected A:B with 0 <= A < B)\n", str);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/* benchmark statistics and A/B comparison */
+
+struct bench {
+    const char* name;
+    int count;
+    float* samples;
+    double mean;
+    double median;
+    double p95;
+    double p99;
+    double stddev;
+    double min;
+    double max;
+};
+
+static int glook_float_compare(const void* a, const void* b)
+{
+    const float fa = *(const float*)a, fb = *(const float*)b;
+    return (fa > fb) - (fa < fb);
+}
+
+static double glook_percentile(const float* sorted, const int count, const double p)
+{
+    const double x = p * (double)(count - 1);
+    const int i = (int)x;
+    if (i + 1 >= count) {
+        return sorted[count - 1];
+    }
+    return sorted[i] + (sorted[i + 1] - sorted[i]) * (x - (double)i);
+}
+
+static double glook_erfc(const double x)
+{
+    /* Abramowitz and Stegun 7.1.26, absolute error below 1.5e-7 */
+    const double z = x < 0.0 ? -x : x, t = 1.0 / (1.0 + 0.3275911 * z);
+    const double y = t * (0.254829592 + t * (-0.284496736 + t * (1.421413741 + 
+        t * (-1.453152027 + t * 1.061405429)))) * exp(-z * z);
+    return x < 0.0 ? 2.0 - y : y;
+}
+
+static void glook_bench_compute(struct bench* bench)
+{
+    int i;
+    double sum = 0.0, var = 0.0;
+    float* sorted = (float*)malloc(bench->count * sizeof(float));
+    memcpy(sorted, bench->samples, bench->count * sizeof(float));
+    qsort(sorted, bench->count, sizeof(float), glook_float_compare);
+    for (i = 0; i < bench->count; ++i) {
+        sum += sorted[i];
+    }
+
+    bench->mean = sum / (double)bench->count;
+    for (i = 0; i < bench->count; ++i) {
+        var += (sorted[i] - bench->mean) * (sorted[i] - bench->mean);
+    }
+
+    bench->stddev = bench->count > 1 ? sqrt(var / (double)(bench->count - 1)) : 0.0;
+    bench->median = glook_percentile(sorted, bench->count, 0.5);
+    bench->p95 = glook_percentile(sorted, bench->count, 0.95);
+    bench->p99 = glook_percentile(sorted, bench->count, 0.99);
+    bench->min = sorted[0];
+    bench->max = sorted[bench->count - 1];
+    free(sorted);
+}
+
+static double glook_bench_welch(const struct bench* a, const struct bench* b, double* p)
+{
+    /* two sided welch t-test, normal approximation holds for benchmark sizes */
+    const double va = a->stddev * a->stddev / a->count;
+    const double vb = b->stddev * b->stddev / b->count;
+    const double t = va + vb > 0.0 ? (b->mean - a->mean) / sqrt(va + vb) : 0.0;
+    *p = glook_erfc((t < 0.0 ? -t : t) / sqrt(2.0));
+    return t;
+}
+
+static void glook_bench_log(const struct bench* bench)
+{
+    glook_log("%s\n", bench->name);
+    fprintf(glook_log_stream(),
+        "  mean %.3f ms\tmedian %.3f ms\tp95 %.3f ms\tp99 %.3f ms\n"
+        "  stddev %.3f ms\tmin %.3f ms\tmax %.3f ms\tframes %d\n",
+        bench->mean, bench->median, bench->p95, bench->p99,
+        bench->stddev, bench->min, bench->max, bench->count
+    );
+}
+
+static void glook_bench_json_run(FILE* file, const struct bench* bench)
+{
+    fprintf(file, "    {\"name\": ");
+    glook_trace_string(file, bench->name);
+    fprintf(file, ", \"frames\": %d, \"mean\": %.4f, \"median\": %.4f, "
+        "\"p95\": %.4f, \"p99\": %.4f, \"stddev\": %.4f, \"min\": %.4f, \"max\": %.4f}",
+        bench->count, bench->mean, bench->median, bench->p95, bench->p99,
+        bench->stddev, bench->min, bench->max
+    );
+}
+
+static int glook_bench_json(const char* path,
+    const struct bench* benches, const int count, const int warmup)
+{
+    int i;
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        glook_error_log("could not write benchmark file '%s'\n", path);
+        return EXIT_FAILURE;
+    }
+
+    fprintf(file, "{\n  \"renderer\": ");
+    glook_trace_string(file, (const char*)glGetString(GL_RENDERER));
+    fprintf(file, ",\n  \"width\": %d,\n  \"height\": %d,\n  \"warmup\": %d,\n",
+        glook.width * GLOOK_SCALE, glook.height * GLOOK_SCALE, warmup
+    );
+
+    fprintf(file, "  \"unit\": \"ms\",\n  \"runs\": [\n");
+    for (i = 0; i < count; ++i) {
+        glook_bench_json_run(file, benches + i);
+        fprintf(file, i + 1 < count ? ",\n" : "\n");
+    }
+    fprintf(file, "  ]");
+
+    if (count == 2) {
+        double p, t = glook_bench_welch(benches, benches + 1, &p);
+        fprintf(file, ",\n  \"comparison\": {\"delta\": %.4f, \"ratio\": %.4f, "
+            "\"t\": %.4f, \"p\": %.6f}",
+            benches[1].mean - benches[0].mean, benches[1].mean / benches[0].mean, t, p
+        );
+    }
+
+    fprintf(file, "\n}\n");
+    return fclose(file);
 }
 
-/* window and OpenGL buffers */
+/* benchmark mode, frames are rendered back to back and timed to completion */
 
-static void glook_window_size_callback(GLFWwindow* window, int width, int height)
+static float glook_bench_frame(struct pipeline* pipeline, const int frame, float* mouse)
 {
-    (void)window;
-    glook.width = width;
-    glook.height = height;
-    glViewport(0, 0, width * GLOOK_SCALE, height * GLOOK_SCALE);
+    const double start = glook_clock();
+    const float dt = 1.0F / (float)glook.opts.fps;
+    glook_shader_pipeline_render(pipeline, frame, glook_frame_time(frame), dt, mouse);
+    if (!glook.opts.headless) {
+        glfwSwapBuffers(glook.window);
+        glfwPollEvents();
+    }
+
+    glFinish();
+    return (float)((glook_clock() - start) * 1000.0);
 }
 
-static unsigned int glook_buffer_quad_create(void)
+static int glook_bench(const char* abpath, const char* commonpath, const char* jsonpath)
 {
-    const float vertices[] = {
-        1.0f,   1.0f,
-        1.0f,   -1.0f,
-        -1.0f,  -1.0f,
-        -1.0f,  1.0f
-    };
-    
-    const unsigned int indices[] = {
-        0,  1,  3,
-        1,  2,  3 
-    };
+    int i, j, k, n, count = 1, err = EXIT_SUCCESS;
+    const int frames = glook.opts.bench;
+    float mouse[4] = {0.0F, 0.0F, 0.0F, 0.0F};
+    struct pipeline* pipelines[2];
+    struct pipeline abpipeline = {0};
+    struct bench benches[2] = {{0}};
+
+    pipelines[0] = &glook.pipeline;
+    pipelines[1] = &abpipeline;
+    if (abpath) {
+        glook_filepaths_push(abpath);
+        glook_shader_pipeline_load(&abpipeline, commonpath ? glook_strdup(commonpath) : NULL);
+        if (!abpipeline.count) {
+            glook_error_log("could not compile comparison shader '%s'\n", abpath);
+            glook_shader_pipeline_free(&abpipeline);
+            return EXIT_FAILURE;
+        }
+        count = 2;
+    }
 
-    unsigned int id, VBO, EBO;
-    glGenVertexArrays(1, &id);
-    glBindVertexArray(id);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);  
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, NULL);
-    return id;
-}
+    if (glook_loader_poll(&glook.loader, 1)) {
+        for (i = 0; i < count; ++i) {
+            glook_shader_pipeline_resolution(pipelines[i]);
+        }
+    }
 
-static int glook_window_create(
-    const char* title, int width, int height, unsigned int fullscreen)
-{
-    GLFWwindow* window;
-    if (width < 1 || height < 1) {
-        glook_error_log("invalid resolution: %d x %d\n", width, height);
-        return EXIT_FAILURE;
+    glook_log("benchmarking %d frames at %d x %d after %d warmup frames\n",
+        frames, glook.width * GLOOK_SCALE, glook.height * GLOOK_SCALE, GLOOK_BENCH_WARMUP
+    );
+    glook_log("renderer: %s\n", (const char*)glGetString(GL_RENDERER));
+
+    for (i = 0; i < count; ++i) {
+        benches[i].name = glook_pipeline_head(pipelines[i])->fpath;
+        benches[i].samples = (float*)malloc(frames * sizeof(float));
+        for (j = 0; j < GLOOK_BENCH_WARMUP; ++j) {
+            glook_bench_frame(pipelines[i], j, mouse);
+        }
     }
 
-#ifdef __APPLE__
-    glfwWindowHint(GLFW_SAMPLES, 4);
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);    
-    glfwWindowHint(GLFW_COCOA_RETINA_FRAMEBUFFER, GLFW_TRUE);
-    glfwWindowHint(GLFW_COCOA_GRAPHICS_SWITCHING, GLFW_TRUE);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
-#endif
+    /* pipelines alternate in short blocks so drift and throttling hit both */
+    for (j = 0; j < frames; j += GLOOK_BENCH_BLOCK) {
+        n = MIN(GLOOK_BENCH_BLOCK, frames - j);
+        for (i = 0; i < count; ++i) {
+            for (k = j; k < j + n; ++k) {
+                benches[i].samples[benches[i].count++] = glook_bench_frame(
+                    pipelines[i], GLOOK_BENCH_WARMUP + k, mouse
+                );
+            }
+        }
 
-    if (fullscreen) {
-        GLFWmonitor* monitor = glfwGetPrimaryMonitor();
-        const GLFWvidmode* mode = glfwGetVideoMode(monitor);
-        glfwWindowHint(GLFW_RED_BITS, mode->redBits);
-        glfwWindowHint(GLFW_GREEN_BITS, mode->greenBits);
-        glfwWindowHint(GLFW_BLUE_BITS, mode->blueBits);
-        glfwWindowHint(GLFW_REFRESH_RATE, mode->refreshRate);
-        window = glfwCreateWindow(mode->width, mode->height, title,monitor, NULL);
-        glook.width = mode->width;
-        glook.height = mode->height;
-    } else {
-        window = glfwCreateWindow(width, height, title, NULL, NULL);
-        glook.width = width;
-        glook.height = height;
+        if (!glook.opts.headless && glfwWindowShouldClose(glook.window)) {
+            break;
+        }
     }
 
-    if (window == NULL) {
-        glook_error_log("could not open a glfw window\n");
-        glfwTerminate();
-        return EXIT_FAILURE;
+    for (i = 0; i < count && benches[i].count; ++i) {
+        glook_bench_compute(benches + i);
+        glook_bench_log(benches + i);
     }
 
-    glfwMakeContextCurrent(window);
-    glfwSwapInterval(1);
+    if (count == 2 && benches[1].count > 1) {
+        double p, t = glook_bench_welch(benches, benches + 1, &p);
+        glook_log("%s vs %s: %+.3f ms (%+.2f%%)\tt = %.3f\tp = %.4f\t%s\n",
+            benches[1].name, benches[0].name, benches[1].mean - benches[0].mean,
+            (benches[1].mean / benches[0].mean - 1.0) * 100.0, t, p,
+            p < 0.05 ? "significant" : "not significant"
+        );
+    }
 
-    glfwSetWindowAspectRatio(window, width, height);
-    glfwSetWindowSizeCallback(window, glook_window_size_callback);
-    glfwSetDropCallback(window, glook_file_drop_callback);
-    glfwSetKeyCallback(window, glook_keyboard_callback);
+    if (jsonpath && benches[0].count) {
+        err = glook_bench_json(jsonpath, benches, count, GLOOK_BENCH_WARMUP);
+    }
 
-#ifndef __APPLE__
-    glewExperimental = GL_TRUE;
-    if (glewInit() != GLEW_OK) {
-        glook_error_log("failed to initiate glew\n");
-        glfwTerminate();
-        return EXIT_FAILURE;
+    for (i = 0; i < count; ++i) {
+        free(benches[i].samples);
     }
-#endif
 
-    glook_buffer_quad_create();
-    glook.window = window;
-    glook.vshader = glCreateShader(GL_VERTEX_SHADER);
-    glook_shader_compile(glook.vshader, glook_shader_string_quad, NULL, NULL);
-    return EXIT_SUCCESS;
+    glook_shader_pipeline_free(&abpipeline);
+    return err;
 }
 
-/* main glook utilities and abstractions */
+/* corpus validation, every shader is compiled and linked by a pool of worker processes */
 
-static float glook_time(void)
+static int glook_check_path_compare(const void* a, const void* b)
 {
-    return (float)glfwGetTime();
+    return strcmp(*(char* const*)a, *(char* const*)b);
 }
 
-static int glook_clear(void)
+static int glook_check_diagnostic_compare(const void* a, const void* b)
 {
-    glook_shader_pipeline_clear(&glook.pipeline);
-    glfwSwapBuffers(glook.window);
-    glfwPollEvents();
-    return !glfwWindowShouldClose(glook.window);
+    const struct diagnostic *x = (const struct diagnostic*)a, *y = (const struct diagnostic*)b;
+    return x->index != y->index ? x->index - y->index : x->order - y->order;
 }
 
-static void glook_deinit(void)
-{ 
-    glook_filepaths_free();
-    glook_shader_pipeline_free(&glook.pipeline);
-    if (glook.vshader) {
-        glDeleteShader(glook.vshader);
+static void glook_check_collect(
+    const char* path, const int top, char*** paths, int* count, int* capacity)
+{
+    struct stat st;
+    struct dirent* entry;
+    const char* ext = strrchr(path, '.');
+    const size_t len = strlen(path);
+    DIR* dir;
+    if (stat(path, &st)) {
+        glook_error_log("could not access '%s'\n", path);
+        return;
     }
 
-    glook_shader_free(&glook.shaderpass);
-    glfwTerminate();
+    /* a file named directly is checked whatever its extension */
+    if (!S_ISDIR(st.st_mode)) {
+        if (S_ISREG(st.st_mode) && (top || (ext && !strcmp(ext, ".frag")))) {
+            if (*count == *capacity) {
+                *capacity = *capacity ? *capacity * 2 : 64;
+                *paths = (char**)realloc(*paths, *capacity * sizeof(char*));
+            }
+            (*paths)[(*count)++] = glook_strdup(path);
+        }
+        return;
+    }
+
+    dir = opendir(path);
+    if (!dir) {
+        glook_error_log("could not open directory '%s'\n", path);
+        return;
+    }
+
+    while ((entry = readdir(dir))) {
+        char* sub;
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        sub = (char*)malloc(len + strlen(entry->d_name) + 2);
+        sprintf(sub, len && path[len - 1] == '/' ? "%s%s" : "%s/%s", path, entry->d_name);
+        glook_check_collect(sub, 0, paths, count, capacity);
+        free(sub);
+    }
+    closedir(dir);
 }
 
-static int glook_init(int width, int height, int fullscreen, char* commonpath)
+static int glook_check_file(const int index, const char* path, const struct common* common)
 {
-    if (!glook.filecount) {
-        glook_error_log("no input files\n");
+    char log[LOGSIZE];
+    int success = 0;
+    unsigned int fshader, program;
+    char* source = glook_file_shader_read(path, common);
+    if (!source) {
+        fprintf(glook.check.file, "D %d 0 0 0 could not read the file\n", index);
         return EXIT_FAILURE;
     }
-    
+
+    glook.check.index = index;
+    fshader = glCreateShader(GL_FRAGMENT_SHADER);
+    if (!glook_shader_compile(fshader, source, path, common)) {
+        /* linked against the vertex stage, a missing mainImage only shows up here */
+        program = glCreateProgram();
+        glAttachShader(program, glook.vshader);
+        glAttachShader(program, fshader);
+        glLinkProgram(program);
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            glGetProgramInfoLog(program, LOGSIZE, NULL, log);
+            glook_compile_error_log(log, source, path, common);
+        }
+        glDeleteProgram(program);
+    }
+
+    glDeleteShader(fshader);
+    free(source);
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static void glook_check_worker(
+    const int jobs, FILE* results, char** paths, const char* commonpath)
+{
+    int index;
+    struct common common;
+    glook.opts.headless = 1;
+#ifndef __APPLE__
+    glook.egldisplay = EGL_NO_DISPLAY;
+#else
     if (!glfwInit()) {
-        glook_error_log("failed to initiate glfw\n");
-        glook_filepaths_free();
-        return EXIT_FAILURE;
+        _exit(EXIT_FAILURE);
     }
+#endif
 
-    if (glook_window_create("glook", width, height, fullscreen)) {
-        glook_deinit();
-        return EXIT_FAILURE;
+    /* a worker without a context leaves its share of the queue to the others */
+    if (glook_headless_create(1, 1) || glook_gl_init()) {
+        _exit(EXIT_FAILURE);
     }
 
-    glook_shader_pipeline_load(&glook.pipeline, commonpath);
-    if (!glook.pipeline.count) {
-        glook_error_log("could not succesfully compile any shader\n");
-        glook_deinit();
-        return EXIT_FAILURE;
+    common = glook_common_create(commonpath ? glook_strdup(commonpath) : NULL);
+    glook.check.file = results;
+    while (read(jobs, &index, sizeof(int)) == sizeof(int)) {
+        /* a file begun and never ended took the driver down with it */
+        fprintf(results, "B %d\n", index);
+        fflush(results);
+        fprintf(results, "E %d %d\n", index, glook_check_file(index, paths[index], &common));
     }
 
-    glook.shaderpass = glook_shader_load_buffer(glook_shader_string_pass, NULL, NULL);
-    glook.opts.limit = GLOOK_SHADER_COUNT - 1;
-    return EXIT_SUCCESS;
+    fflush(results);
+    glook_common_free(&common);
+    glook_headless_destroy();
+    _exit(EXIT_SUCCESS);
 }
 
-static int glook_file_modstr(char* modstr, const char* fpath)
+static void glook_check_read(FILE* results, const int count, int* status,
+    struct diagnostic** diagnostics, int* diagcount, int* capacity)
 {
-    struct stat st;
-    if (stat(fpath, &st)) {
-        glook_error_log("could not find file: '%s'\n", fpath);
-        return EXIT_FAILURE;
+    char line[LOGSIZE + 64];
+    struct diagnostic d;
+    int index, err, n = 0;
+    rewind(results);
+    while (fgets(line, sizeof(line), results)) {
+        line[strcspn(line, "\n")] = 0;
+        if (sscanf(line, "B %d", &index) == 1 && index >= 0 && index < count) {
+            status[index] = GLOOK_CHECK_CRASHED;
+        } else if (sscanf(line, "E %d %d", &index, &err) == 2 && index >= 0 && index < count) {
+            status[index] = err ? GLOOK_CHECK_FAILED : GLOOK_CHECK_PASSED;
+        } else if (sscanf(line, "D %d %d %d %d %n",
+            &d.index, &d.line, &d.column, &d.common, &n) == 4 && n &&
+            d.index >= 0 && d.index < count) {
+            if (*diagcount == *capacity) {
+                *capacity = *capacity ? *capacity * 2 : 64;
+                *diagnostics = (struct diagnostic*)realloc(
+                    *diagnostics, *capacity * sizeof(struct diagnostic)
+                );
+            }
+            d.order = *diagcount;
+            d.message = glook_strdup(line + n);
+            (*diagnostics)[(*diagcount)++] = d;
+        }
     }
-
-    strcpy(modstr, ctime(&st.st_mtime));
-    return EXIT_SUCCESS;
 }
 
-static void glook_run(void)
+static void glook_check_report(FILE* file, const char* path,
+    const int line, const int column, const char* message, int* written)
 {
-    char modstr[0xff], mod[0xff];
-    unsigned int i, frame = 0, reload = 0, pause = 0;
-    float mouse[4], t = 0.0F, dt = 1.0F, T = 0.0F, tzero = 0.0F, pt = 0.0F;
+    fprintf(file, (*written)++ ? ",\n    {\"file\": " : "\n    {\"file\": ");
+    glook_trace_string(file, path);
+    fprintf(file, ", \"line\": %d, \"column\": %d, \"message\": ", line, column);
+    glook_trace_string(file, message);
+    fputc('}', file);
+    glook_compile_error_print(path, line, column, message);
+}
 
-    glook_file_modstr(modstr, glook.pipeline.shaders[glook.pipeline.count - 1].fpath);
-    while (glook_clear()) {
-        if (glook_key_pressed(GLFW_KEY_ESCAPE)) {
-            break;
-        }
-        if (glook_key_pressed(GLFW_KEY_R)) {
-            ++reload;
-        }
-        if (glook_key_pressed(GLFW_KEY_T)) {
-            tzero = t;
-            frame = 0;
-        }
-        if (glook_key_pressed(GLFW_KEY_SPACE)) {
-            pause = !pause;
-        }
-        if (glook_key_pressed(GLFW_KEY_I)) {
-            glook_log(
-                "\niFrame: %u\niTime: %f\niResolution: %u x %u\niMouse: %.2f x %.2f\n",
-                frame, t, glook.width * GLOOK_SCALE, glook.height * GLOOK_SCALE,
-                mouse[0], mouse[1]
-            );
-        }
-        if (glook.pipeline.count > 1 && glook_key_pressed(GLFW_KEY_BACKSPACE)) {
-            glook_shader_free(glook.pipeline.shaders + --glook.pipeline.count);
-        }
+static int glook_check(const char* dirpath, const char* commonpath, const char* jsonpath)
+{
+    static const char* reasons[] = {
+        "not checked, no worker could create a context", NULL,
+        "compilation failed without a message", "the compiler crashed"
+    };
+    int i, j, k, jobs[2], count = 0, capacity = 0, diagcount = 0, workers = 0;
+    int failed = 0, written = 0;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    pid_t pids[GLOOK_CHECK_WORKERS];
+    FILE* results[GLOOK_CHECK_WORKERS];
+    struct diagnostic* diagnostics = NULL;
+    char** paths = NULL;
+    int* status;
+    FILE* file;
 
-        if (glook.opts.autoreload) {
-            glook.opts.autoreload++;
-            if (glook.opts.autoreload >= GLOOK_AUTORELOAD_COUNT) {
-                glook.opts.autoreload = 1;
-                if (!glook_file_modstr(
-                    mod, glook.pipeline.shaders[glook.pipeline.count - 1].fpath) &&
-                    strcmp(modstr, mod)) {
-                    strcpy(modstr, mod);
-                    ++reload;
-                }
-            }
-        }
+    glook_check_collect(dirpath, 1, &paths, &count, &capacity);
+    if (!count) {
+        glook_error_log("no shaders to check under '%s'\n", dirpath);
+        return EXIT_FAILURE;
+    }
+    if (pipe(jobs)) {
+        glook_error_log("could not create the check job queue\n");
+        return EXIT_FAILURE;
+    }
 
-        for (i = 0; i < GLOOK_SHADER_COUNT; ++i) {
-            if (glook_key_pressed(i + 48)) {
-                glook.opts.limit = i;
-                break;
-            }
+    /* sorted so the report does not depend on directory order or scheduling */
+    qsort(paths, count, sizeof(char*), glook_check_path_compare);
+    cores = cores < 1 ? 1 : cores > GLOOK_CHECK_WORKERS ? GLOOK_CHECK_WORKERS : cores;
+    cores = MIN(cores, count);
+    signal(SIGPIPE, SIG_IGN);
+    fflush(stdout);
+    fflush(stderr);
+    for (i = 0; i < cores; ++i) {
+        results[workers] = tmpfile();
+        pids[workers] = results[workers] ? fork() : -1;
+        if (!pids[workers]) {
+            close(jobs[1]);
+            glook_check_worker(jobs[0], results[workers], paths, commonpath);
+        } else if (pids[workers] > 0) {
+            ++workers;
+        } else if (results[workers]) {
+            fclose(results[workers]);
         }
+    }
 
-        if (glook.filepaths[0]) {
-            glook_file_drop(&glook.pipeline);
-            ++reload;
+    /* indices are handed out one at a time, slow files do not hold up a worker's share */
+    close(jobs[0]);
+    for (i = 0; i < count; ++i) {
+        if (write(jobs[1], &i, sizeof(int)) != sizeof(int)) {
+            break;
         }
+    }
+    close(jobs[1]);
+
+    status = (int*)calloc(count, sizeof(int));
+    capacity = 0;
+    for (i = 0; i < workers; ++i) {
+        waitpid(pids[i], NULL, 0);
+        glook_check_read(results[i], count, status, &diagnostics, &diagcount, &capacity);
+        fclose(results[i]);
+    }
+    qsort(diagnostics, diagcount, sizeof(struct diagnostic), glook_check_diagnostic_compare);
 
-        if (reload) {
-            glook_shader_pipeline_reload(&glook.pipeline);
-            tzero = t;
-            frame = 0;
-            reload = 0;
-        }
+    file = jsonpath ? fopen(jsonpath, "w") : stdout;
+    if (!file) {
+        glook_error_log("could not write check results to '%s'\n", jsonpath);
+        file = stdout;
+    }
 
-        if (glook.opts.dperf && !(frame % 2)) {
-            glook_log("%d x %d\tfps: %f\tframe: %lu\ttime: %f\r",
-                glook.width * GLOOK_SCALE, glook.height * GLOOK_SCALE,
-                1.0F / dt, frame, t
+    for (i = 0; i < count; ++i) {
+        failed += status[i] != GLOOK_CHECK_PASSED;
+    }
+    fprintf(file, "{\n  \"files\": %d,\n  \"failed\": %d,\n  \"errors\": [", count, failed);
+    for (i = j = 0; i < count; ++i) {
+        for (k = j; j < diagcount && diagnostics[j].index == i; ++j) {
+            const struct diagnostic* d = diagnostics + j;
+            glook_check_report(file, d->common && commonpath ? commonpath : paths[i],
+                d->line, d->column, d->message, &written
             );
         }
-
-        if (pause) {
-            pt = glook_time() - t;
-            continue;
+        if (status[i] != GLOOK_CHECK_PASSED && (status[i] != GLOOK_CHECK_FAILED || j == k)) {
+            glook_check_report(file, paths[i], 0, 0, reasons[status[i]], &written);
         }
+    }
+    fprintf(file, written ? "\n  ]\n}\n" : "]\n}\n");
+    if (file != stdout) {
+        fclose(file);
+    }
 
-        t = glook_time() - pt;
-        dt = t - T;
-        T = t;
-        t -= tzero;
+    fprintf(stderr, COLBLD "glook: " COLNRM "checked %d shaders on %d workers, %d failed\n",
+        count, workers, failed
+    );
 
-        glook_mouse_get(mouse);
-        glook_shader_pipeline_render(&glook.pipeline, frame++, t, dt, mouse);
+    for (i = 0; i < diagcount; ++i) {
+        free(diagnostics[i].message);
+    }
+    for (i = 0; i < count; ++i) {
+        free(paths[i]);
     }
+    free(diagnostics);
+    free(paths);
+    free(status);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
 }
 
 static void glook_usage(void)
@@ -1159,10 +6512,11 @@ static void glook_usage(void)
         "-h <uint>\t: set the height of the rendering window to <uint> pixels\n"
         "-f\t\t: visualize shader in fullscreen resolution\n"
         "-d\t\t: print runtime information about display and rendering\n"
+        "-target-ms <ms>\t: scale the render resolution to keep gpu frame time under <ms>\n"
     );
 
     fprintf(stdout,
-        "-m\t\t: constantly search and reload when modified shaders are found\n"
+        "-m\t\t: watch every pass and the common file, reload on modification\n"
         "-[0-9]\t\t: set input of all shaders to specified index\n"
         "-chain\t\t: set structure of shader pipeline to link as a single chain\n"
         "-template\t: write template shader 'template.frag' at current directory\n"
@@ -1170,12 +6524,53 @@ static void glook_usage(void)
         "-help, --help\t: print this help message\n\n"
     );
 
+    fprintf(stdout,
+        "passes:\n<file>:0,1\t: read passes 0 and 1 as iChannel0 and iChannel1\n"
+        "<file>:<format>\t: store the pass as rgba8, rgba16f, r32f or rgba32f (default)\n"
+        "<file>:1/2\t: render the pass at a fraction of the output or a fixed WxH size\n"
+    );
+
+    fprintf(stdout,
+        "<file>:<image>\t: read a png, jpeg, qoi or hdr image file as the next channel\n"
+        "<file>:<video>\t: play a y4m video or 'name%%d.png' sequence along iTime\n"
+        "<file>:<audio>\t: read a wav file as a 512x2 spectrum and waveform texture\n"
+        "#pragma glook format(<format>) or resolution(<N/D|WxH>) : set from the source\n\n"
+    );
+
+    fprintf(stdout,
+        "offline:\n-headless\t: render offscreen without a window or display\n"
+        "-frames <A:B>\t: render frames in range [A, B) with a fixed timestep\n"
+        "-fps <uint>\t: set frames per second of the fixed timestep (default 60)\n"
+        "-o <file>\t: stream rendered frames to <file> as YUV4MPEG2, '-' for stdout\n"
+        "-o <name%%d.png>\t: write frames as a numbered png or qoi image sequence\n"
+        "-raw\t\t: stream frames as raw RGBA bytes instead of YUV4MPEG2\n"
+    );
+
+    fprintf(stdout,
+        "-trace <file>\t: record a chrome://tracing timeline of every stage as json\n"
+        "-tile <uint>\t: render the output in tiles of <uint> pixels for png or raw exports\n"
+        "-spp <uint>\t: average <uint> jittered samples per pixel in exported frames\n"
+        "-golden <dir>\t: compare frames with reference pngs in <dir>, recording missing ones\n"
+        "-tolerance <uint>: allowed per channel difference from golden references (default 0)\n"
+        "-nocache\t: skip the program binary and decoded image caches\n\n"
+    );
+
+    fprintf(stdout,
+        "benchmark:\n-bench <uint>\t: time <uint> frames without vsync after a warmup\n"
+        "-ab <file>\t: benchmark <file> against the pipeline and test the difference\n"
+        "-json <file>\t: write benchmark statistics or check results to <file> as json\n\n"
+    );
+
+    fprintf(stdout,
+        "validation:\n-check <dir>\t: compile every .frag under <dir> in parallel, errors as json\n\n"
+    );
+
     glook_log(
         "controls:\nEscape\t\t: exit the program\n"
         "Space\t\t: pause time and rendering for all shaders\n"
         "Backspace\t: remove shader at the top of the pipeline stack\n"
         "[0-9]\t\t: visualize from the shader at the selected index\n"
-        "R\t\t: reload all shaders in the pipeline\n"
+        "R\t\t: recompile all shaders in the pipeline and reset time\n"
         "T\t\t: set time and frame global counters to zero\n"
         "I\t\t: print information about the values of the global uniforms\n\n"
     );
@@ -1183,11 +6578,16 @@ static void glook_usage(void)
 
 int main(int argc, char** argv)
 {
-    char* commonpath = NULL;
-    int i, width = 640, height = 360, fullscreen = 0;
+    char *commonpath = NULL, *framestr = NULL, *outpath = NULL, *tracepath = NULL;
+    char *abpath = NULL, *jsonpath = NULL, *targetstr = NULL, *checkpath = NULL;
+    char* goldenpath = NULL;
+    unsigned int raw = 0, format = GLOOK_EXPORT_NONE;
+    int err = EXIT_SUCCESS, bench = 0, tile = 0, spp = 1, tolerance = 0;
+    int i, width = 640, height = 360, fullscreen = 0, fps = GLOOK_HEADLESS_FPS;
     for (i = 1; i < argc; i++) {
         if (argv[i][0] == '-') {
             int c = 0, *p = NULL;
+            char** s = NULL;
             if (!strcmp(argv[i] + 1, "help") || !strcmp(argv[i] + 1, "-help")) {
                 glook_usage();
                 return EXIT_SUCCESS;
@@ -1199,6 +6599,38 @@ int main(int argc, char** argv)
                 return EXIT_SUCCESS;
             } else if (!strcmp(argv[i] + 1, "chain")) {
                 glook.opts.mode = GLOOK_MODE_CHAIN;
+            } else if (!strcmp(argv[i] + 1, "headless")) {
+                ++glook.opts.headless;
+            } else if (!strcmp(argv[i] + 1, "frames")) {
+                s = &framestr;
+            } else if (!strcmp(argv[i] + 1, "fps")) {
+                p = &fps;
+            } else if (!strcmp(argv[i] + 1, "trace")) {
+                s = &tracepath;
+            } else if (!strcmp(argv[i] + 1, "target-ms")) {
+                s = &targetstr;
+            } else if (!strcmp(argv[i] + 1, "bench")) {
+                p = &bench;
+            } else if (!strcmp(argv[i] + 1, "ab")) {
+                s = &abpath;
+            } else if (!strcmp(argv[i] + 1, "json")) {
+                s = &jsonpath;
+            } else if (!strcmp(argv[i] + 1, "check")) {
+                s = &checkpath;
+            } else if (!strcmp(argv[i] + 1, "nocache")) {
+                ++glook.opts.nocache;
+            } else if (!strcmp(argv[i] + 1, "raw")) {
+                ++raw;
+            } else if (!strcmp(argv[i] + 1, "tile")) {
+                p = &tile;
+            } else if (!strcmp(argv[i] + 1, "spp")) {
+                p = &spp;
+            } else if (!strcmp(argv[i] + 1, "golden")) {
+                s = &goldenpath;
+            } else if (!strcmp(argv[i] + 1, "tolerance")) {
+                p = &tolerance;
+            } else if (argv[i][1] == 'o' && !argv[i][2]) {
+                s = &outpath;
             } else if (argv[i][1] >= '0' && argv[i][1] <= '9' && !argv[i][2]) {
                 glook.opts.mode = GLOOK_MODE_DIRECT + argv[i][1] - '0';
             } else if (argv[i][1] == 'w' && !argv[i][2]) {
@@ -1217,7 +6649,7 @@ int main(int argc, char** argv)
                 glook_error_log("unknown argument: '%s'\n", argv[i]);
             }
 
-            if (p || c) {
+            if (p || c || s) {
                 if (i + 1 >= argc) {
                     glook_error_log(
                         "argument to '%s' is missing (expected 1 value)\n", 
@@ -1230,6 +6662,8 @@ int main(int argc, char** argv)
                             argv[i]
                         );
                     } else commonpath = glook_strdup(argv[++i]);
+                } else if (s) {
+                    *s = argv[++i];
                 } else {
                     *p = atoi(argv[++i]);
                 }
@@ -1237,12 +6671,100 @@ int main(int argc, char** argv)
         } else glook_filepaths_push(argv[i]);
     }
 
-    if (glook_init(width, height, fullscreen, commonpath)) {
+    /* validation compiles in worker processes, this one never opens a context */
+    if (checkpath) {
+        err = glook_check(checkpath, commonpath, jsonpath);
+        glook_filepaths_free();
+        free(commonpath);
+        return err;
+    }
+
+    /* golden frames go through the readback like any export, just never to a file */
+    if (goldenpath) {
+        if (outpath || tile || bench) {
+            glook_error_log("-golden cannot be combined with -o, -tile or -bench\n");
+            free(commonpath);
+            return EXIT_FAILURE;
+        }
+        if (tolerance < 0) {
+            glook_error_log("invalid golden tolerance: %d\n", tolerance);
+            free(commonpath);
+            return EXIT_FAILURE;
+        }
+        glook.opts.tolerance = tolerance;
+        glook.opts.headless = 1;
+        outpath = goldenpath;
+        format = GLOOK_EXPORT_GOLDEN;
+    } else if (outpath) {
+        format = glook_readback_format(outpath, raw);
+    }
+
+    glook.opts.frames[1] = 1;
+    if (framestr && glook_frames_parse(framestr, glook.opts.frames)) {
+        free(commonpath);
         return EXIT_FAILURE;
     }
 
-    glook_run(); 
-    glook_deinit();
-    return EXIT_SUCCESS;
+    if (fps < 1) {
+        glook_error_log("invalid frames per second: %d\n", fps);
+        free(commonpath);
+        return EXIT_FAILURE;
+    }
+    glook.opts.fps = fps;
+    if (bench < 0) {
+        glook_error_log("invalid benchmark frame count: %d\n", bench);
+        bench = 0;
+    }
+    glook.opts.bench = bench;
+    if (tile < 0) {
+        glook_error_log("invalid tile size: %d\n", tile);
+        free(commonpath);
+        return EXIT_FAILURE;
+    } else if (tile && (!glook.opts.headless || !outpath || bench)) {
+        glook_error_log("-tile only applies to headless exports with -o\n");
+        free(commonpath);
+        return EXIT_FAILURE;
+    }
+    glook.opts.tile = tile;
+    if (spp < 1) {
+        glook_error_log("invalid samples per pixel: %d\n", spp);
+        free(commonpath);
+        return EXIT_FAILURE;
+    } else if (spp > 1 && (!glook.opts.headless || !outpath || bench)) {
+        glook_error_log("-spp only applies to headless exports with -o\n");
+        free(commonpath);
+        return EXIT_FAILURE;
+    }
+    glook.opts.spp = spp > 1 ? spp : 0;
+
+    if (targetstr) {
+        char* end;
+        const double ms = strtod(targetstr, &end);
+        if (*end || ms <= 0.0) {
+            glook_error_log("invalid frame time target: '%s'\n", targetstr);
+        } else if (glook.opts.headless || framestr || bench) {
+            glook_error_log("-target-ms only applies to interactive rendering\n");
+        } else {
+            glook.dynres.target = (float)ms;
+            glook.dynres.level = GLOOK_DYNRES_STEPS;
+        }
+    }
+
+    if (glook_init(width, height, fullscreen, commonpath, outpath, format, tracepath)) {
+        return EXIT_FAILURE;
+    }
+
+    if (glook.opts.bench) {
+        err = glook_bench(abpath, commonpath, jsonpath);
+    } else if (glook.opts.headless || framestr) {
+        glook_run_frames();
+    } else glook_run();
+    if (glook_deinit()) {
+        err = EXIT_FAILURE;
+    }
+    if (glook.golden.dir && glook_golden_finish(&glook.golden)) {
+        err = EXIT_FAILURE;
+    }
+    return err;
 }
 